@@ -0,0 +1,152 @@
+#define cimg_display 0
+#include "CImg.h"
+#include "glb_common.hpp"
+#include "glb_cpu.hpp"
+#include "glb_kernels.hpp"
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/*
+    Every dispatched kernel on one texture's worth of random bytes, at the tier GLB_CPU_TIER
+    leaves, against a memcpy of the texture and against CImg where it has the same conversion.
+    Bandwidth is texture bytes over time, so a kernel at the memcpy figure keeps pace with memory.
+    The conversions work in place and are timed over their own output after the first run, which
+    changes nothing for the tables and saturating adds they come down to. Outputs are checked
+    against CImg before timing, and each kernel's output on the source bytes is hashed so that
+    the runs of the bench_tiers target can be compared line for line.
+*/
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const std::size_t planeSize{glb::imgWidth * glb::imgHeight};
+constexpr const std::size_t textureBytes{planeSize * glb::imgCh};
+constexpr const int repetitions{20};
+
+template <typename Fn>
+double averageMs(Fn &&fn) {
+    const Clock::time_point start{Clock::now()};
+    for (int r = 0; r < repetitions; ++r) {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / repetitions;
+}
+
+double gbPerSecond(double ms) { return textureBytes / (ms * 1e6); }
+
+// FNV-1a, enough to tell whether two tiers produced the same bytes.
+std::uint64_t hashBytes(const void *data, std::size_t n) {
+    std::uint64_t hash{0xcbf29ce484222325};
+    for (std::size_t i = 0; i < n; ++i) {
+        hash = (hash ^ static_cast<const std::uint8_t *>(data)[i]) * 0x100000001b3;
+    }
+    return hash;
+}
+
+void report(const char *name, double ms, double copyMs, std::uint64_t hash) {
+    std::printf("%-24s %9.3f %7.2f %7.1f  %016llx\n", name, ms, gbPerSecond(ms), ms / copyMs,
+                static_cast<unsigned long long>(hash));
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::uint8_t> source(textureBytes), planes(textureBytes), copy(textureBytes);
+    std::uint32_t state{0x9e3779b9};
+    for (std::uint8_t &byte : source) {
+        state = state * 1664525 + 1013904223;
+        byte = static_cast<std::uint8_t>(state >> 24);
+    }
+    using Image = cimg_library::CImg<std::uint8_t>;
+    std::uint8_t *const c0{planes.data()};
+    std::uint8_t *const c1{c0 + planeSize};
+    std::uint8_t *const c2{c1 + planeSize};
+
+    std::printf("tier: %s\n\n", glb::tierGetStr(glb::cpuTier()));
+    std::printf("%-24s %9s %7s %7s  %-16s\n", "kernel", "ms", "GB/s", "memcpys", "output hash");
+    const double copyMs{averageMs([&] { std::memcpy(copy.data(), source.data(), textureBytes); })};
+    report("memcpy", copyMs, copyMs, hashBytes(copy.data(), textureBytes));
+
+    // Runs kernel once with both buffers holding the source for the hash, then times it.
+    const auto measure{[&](const char *name, auto &&kernel, const std::uint8_t *output, std::size_t outputSize) {
+        planes = source;
+        copy = source;
+        kernel();
+        const std::uint64_t hash{hashBytes(output, outputSize)};
+        planes = source;
+        report(name, averageMs(kernel), copyMs, hash);
+    }};
+
+    const auto measureCImg{[&](const char *name, Image &(Image::*convert)()) {
+        Image image(source.data(), glb::imgWidth, glb::imgHeight, 1, glb::imgCh);
+        (image.*convert)();
+        const std::uint64_t hash{hashBytes(image.data(), textureBytes)};
+        report(name, averageMs([&] { (image.*convert)(); }), copyMs, hash);
+    }};
+
+    int mismatches{0};
+    const auto checkConversion{[&](const char *name, void (*convert)(std::uint8_t *, std::uint8_t *, std::uint8_t *,
+                                                                      std::size_t),
+                                   Image &(Image::*cimgConvert)()) {
+        Image reference(source.data(), glb::imgWidth, glb::imgHeight, 1, glb::imgCh);
+        (reference.*cimgConvert)();
+        planes = source;
+        convert(c0, c1, c2, planeSize);
+        if (std::memcmp(planes.data(), reference.data(), textureBytes) != 0) {
+            std::printf("%s differs from CImg\n", name);
+            ++mismatches;
+        }
+    }};
+    checkConversion("hsvToRgb", glb::hsvToRgb, &Image::HSVtoRGBModified);
+    checkConversion("ycbcrToRgb", glb::ycbcrToRgb, &Image::YCbCrtoRGB);
+
+    measure("reverseBytes", [&] { glb::reverseBytes(copy.data(), planes.data(), textureBytes); }, copy.data(),
+            textureBytes);
+    measure("deinterleave3", [&] { glb::deinterleave3(c0, c1, c2, copy.data(), planeSize); }, planes.data(),
+            textureBytes);
+    measure("deinterleave3Reversed", [&] { glb::deinterleave3Reversed(c0, c1, c2, copy.data(), planeSize); },
+            planes.data(), textureBytes);
+    measure("hsvToRgb", [&] { glb::hsvToRgb(c0, c1, c2, planeSize); }, planes.data(), textureBytes);
+    measureCImg("CImg HSVtoRGBModified", &Image::HSVtoRGBModified);
+    measure("ycbcrToRgb", [&] { glb::ycbcrToRgb(c0, c1, c2, planeSize); }, planes.data(), textureBytes);
+    measureCImg("CImg YCbCrtoRGB", &Image::YCbCrtoRGB);
+    measure("grayEncode", [&] { glb::grayEncode(copy.data(), planes.data(), textureBytes, 0); }, copy.data(),
+            textureBytes);
+    measure("grayDecode", [&] { glb::grayDecode(copy.data(), planes.data(), textureBytes); }, copy.data(),
+            textureBytes);
+    measure("philoxFill", [&] { glb::philoxFill(copy.data(), textureBytes, 1); }, copy.data(), textureBytes);
+
+    // Pixels in a fixed pseudo-random order, as the permutation modes gather them.
+    std::vector<std::uint32_t> order(planeSize);
+    for (std::size_t k = 0; k < planeSize; ++k) {
+        order[k] = static_cast<std::uint32_t>(k * 1'000'003 % planeSize);
+    }
+    measure("gatherPixels",
+            [&] { glb::gatherPixels(copy.data(), planes.data(), textureBytes, order.data(), planeSize); },
+            copy.data(), textureBytes);
+    constexpr const std::size_t rowSize{textureBytes / CHAR_BIT};
+    measure("transposeBitPlanes", [&] { glb::transposeBitPlanes(copy.data(), planes.data(), rowSize, rowSize); },
+            copy.data(), textureBytes);
+    measure("extractBitRow x8", [&] {
+        for (unsigned row = 0; row < CHAR_BIT; ++row) {
+            glb::extractBitRow(copy.data() + row * rowSize, planes.data(), row, rowSize);
+        }
+    }, copy.data(), textureBytes);
+
+    // Limb kernels over the texture as one number, adding the source bytes into the copy.
+    constexpr const std::size_t limbs{textureBytes / sizeof(std::uint64_t)};
+    std::uint64_t *const dst{reinterpret_cast<std::uint64_t *>(copy.data())};
+    const std::uint64_t *const src{reinterpret_cast<const std::uint64_t *>(planes.data())};
+    constexpr const std::uint64_t factor{0x9e3779b97f4a7c15};
+    glb::ByteRange changed{};
+    measure("addLimbs", [&] { glb::addLimbs(dst, src, limbs, 0, changed); }, copy.data(), textureBytes);
+    measure("subLimbs", [&] { glb::subLimbs(dst, src, limbs, 0, changed); }, copy.data(), textureBytes);
+    measure("addMulLimbs", [&] { glb::addMulLimbs(dst, src, limbs, factor, changed); }, copy.data(), textureBytes);
+    measure("subMulLimbs", [&] { glb::subMulLimbs(dst, src, limbs, factor, changed); }, copy.data(), textureBytes);
+    return mismatches == 0 ? 0 : 1;
+}
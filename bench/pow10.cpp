@@ -0,0 +1,48 @@
+#include "glb_interval.hpp"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+/*
+    Times 10^k for the interval slider from k = 10^3 up to the 6,658,301 the slider reaches,
+    through IntervalEngine without a cache file, so every power is built from scratch the way a
+    first run sees it. mp::pow, what the slider used before BigNat, is timed alongside and
+    every result is checked against it.
+*/
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const std::uint64_t exponents[]{1'000, 10'000, 100'000, 1'000'000, 3'000'000, 6'658'301};
+
+double computeMs(glb::IntervalEngine &engine, std::uint64_t exponent, glb::ImageIndex &result) {
+    const Clock::time_point start{Clock::now()};
+    engine.request(exponent);
+    while (!engine.poll(result)) {
+        std::this_thread::yield();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main() {
+    glb::IntervalEngine engine{};
+    glb::ImageIndex result{};
+    std::printf("%10s %14s %14s\n", "k", "BigNat ms", "mp::pow ms");
+    for (const std::uint64_t exponent : exponents) {
+        const double ms{computeMs(engine, exponent, result)};
+        const Clock::time_point start{Clock::now()};
+        const glb::mp::cpp_int expected{glb::mp::pow(glb::mp::cpp_int{10}, static_cast<unsigned>(exponent))};
+        const double baselineMs{std::chrono::duration<double, std::milli>(Clock::now() - start).count()};
+        std::printf("%10llu %14.1f %14.1f\n", static_cast<unsigned long long>(exponent), ms, baselineMs);
+        if (result.toCppInt() != expected) {
+            std::printf("10^%llu does not match mp::pow\n", static_cast<unsigned long long>(exponent));
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#define cimg_display 0
+#include "CImg.h"
+#include "glb_index.hpp"
+#include "glb_render.hpp"
+#include <algorithm>
+#include <boost/multiprecision/cpp_int/import_export.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/*
+    Full redraws of every spatial x color pair through Renderer, against the pipeline updateTexture
+    ran before rendering was fused: export_bits into a buffer, a copy or planar shuffle, a separate
+    reverse, then CImg's conversion over the whole image. That pipeline is replayed here for the 15
+    pairs it supported, counting its full passes over the image, and its output must match the
+    renderer's byte for byte. Bandwidth is texture bytes over time; memcpy-equivalents is time over
+    that of one memcpy of the texture, an estimate of how many passes the memory system really saw.
+*/
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using glb::ColorSpaceInterpretation;
+using glb::SpatialInterpretation;
+
+constexpr const std::size_t planeSize{glb::imgWidth * glb::imgHeight};
+constexpr const std::size_t textureBytes{planeSize * glb::imgCh};
+constexpr const int repetitions{10};
+constexpr const int legacySpatialModes{static_cast<int>(SpatialInterpretation::GRAY_CODE) + 1};
+
+// The pre-fusion updateTexture, returning how many full passes over the image it made.
+int legacyRender(
+    const glb::mp::cpp_int &idx, SpatialInterpretation sp, ColorSpaceInterpretation clr,
+    std::vector<std::uint8_t> &exportBuffer, std::vector<std::uint8_t> &texture
+) {
+    int passes{0};
+    const auto interleavedToPlanar{[&] {
+        for (std::size_t i = 0; i < planeSize; ++i) {
+            for (std::size_t j = 0; j < glb::imgCh; ++j) {
+                texture[planeSize * j + i] = exportBuffer[i * glb::imgCh + j];
+            }
+        }
+        ++passes;
+    }};
+    if (sp == SpatialInterpretation::GRAY_CODE) {
+        const glb::mp::cpp_int gray{idx ^ (idx >> 1)};
+        glb::mp::export_bits(gray, texture.begin(), CHAR_BIT);
+        passes += 3;
+    } else {
+        glb::mp::export_bits(idx, exportBuffer.begin(), CHAR_BIT);
+        ++passes;
+        if (sp == SpatialInterpretation::INTERLEAVED || sp == SpatialInterpretation::INTERLEAVED_REVERSED) {
+            texture = exportBuffer;
+            ++passes;
+        } else {
+            interleavedToPlanar();
+        }
+        if (sp == SpatialInterpretation::INTERLEAVED_REVERSED || sp == SpatialInterpretation::PLANAR_REVERSED) {
+            std::reverse(texture.begin(), texture.end());
+            ++passes;
+        }
+    }
+    cimg_library::CImg<std::uint8_t> img{texture.data(), glb::imgWidth, glb::imgHeight, 1, glb::imgCh, true};
+    if (clr == ColorSpaceInterpretation::HSV) {
+        img.HSVtoRGBModified();
+        ++passes;
+    } else if (clr == ColorSpaceInterpretation::YCBCR) {
+        img.YCbCrtoRGB();
+        ++passes;
+    }
+    return passes;
+}
+
+template <typename Fn>
+double averageMs(Fn &&fn) {
+    const Clock::time_point start{Clock::now()};
+    for (int r = 0; r < repetitions; ++r) {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / repetitions;
+}
+
+double gbPerSecond(double ms) { return textureBytes / (ms * 1e6); }
+
+} // namespace
+
+int main() {
+    glb::ImageIndex idx{};
+    idx.assignRandom(1);
+    const glb::mp::cpp_int value{idx.toCppInt()};
+    std::vector<std::uint8_t> exportBuffer(textureBytes), legacy(textureBytes), fused(textureBytes);
+    glb::Renderer renderer{};
+
+    const double copyMs{averageMs([&] { std::memcpy(fused.data(), idx.bytes(), textureBytes); })};
+    std::printf("memcpy of the texture: %.3f ms, %.2f GB/s\n\n", copyMs, gbPerSecond(copyMs));
+    std::printf(
+        "%-22s %-6s | %6s %9s %7s %7s | %9s %7s %7s\n", "spatial", "color", "passes", "old ms", "GB/s", "memcpys",
+        "new ms", "GB/s", "memcpys"
+    );
+    int mismatches{0};
+    for (int s = 0; s < static_cast<int>(SpatialInterpretation::COUNT); ++s) {
+        for (int c = 0; c < static_cast<int>(ColorSpaceInterpretation::COUNT); ++c) {
+            const SpatialInterpretation sp{static_cast<SpatialInterpretation>(s)};
+            const ColorSpaceInterpretation clr{static_cast<ColorSpaceInterpretation>(c)};
+            // The first call builds permutation tables, which the app does once per session.
+            renderer.renderAll(sp, clr, idx.bytes(), fused.data());
+            const double newMs{averageMs([&] { renderer.renderAll(sp, clr, idx.bytes(), fused.data()); })};
+            std::printf("%-22s %-6s | ", glb::spGetStr(sp), glb::clrGetStr(clr));
+            if (s < legacySpatialModes) {
+                int passes{0};
+                const double oldMs{averageMs([&] { passes = legacyRender(value, sp, clr, exportBuffer, legacy); })};
+                std::printf("%6d %9.3f %7.2f %7.1f | ", passes, oldMs, gbPerSecond(oldMs), oldMs / copyMs);
+                if (legacy != fused) {
+                    std::printf("(output differs) ");
+                    ++mismatches;
+                }
+            } else {
+                std::printf("%6s %9s %7s %7s | ", "-", "-", "-", "-");
+            }
+            std::printf("%9.3f %7.2f %7.1f\n", newMs, gbPerSecond(newMs), newMs / copyMs);
+        }
+    }
+    return mismatches == 0 ? 0 : 1;
+}
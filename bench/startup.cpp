@@ -0,0 +1,58 @@
+#include "glb_index.hpp"
+#include <algorithm>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/*
+    The index part of ApplicationState's construction, before and after the 2^maxB2 - 1 bound
+    was dropped from it: ApplicationState used to build maxImgIdx with mp::pow on top of the two
+    ImageIndex members it still has. Each variant runs fresh several times and the best and
+    average are reported. The old bound is also checked to be exactly maxB2 bits wide, the width
+    ImageIndex now saturates at.
+*/
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const int repetitions{5};
+
+// Where each run leaves a byte of what it built, so that none of it can be optimized away.
+volatile std::uint64_t sink{};
+
+template <typename Fn>
+void report(const char *name, Fn &&fn) {
+    double best{1e300}, total{0.0};
+    for (int r = 0; r < repetitions; ++r) {
+        const Clock::time_point start{Clock::now()};
+        sink = sink + fn();
+        const double ms{std::chrono::duration<double, std::milli>(Clock::now() - start).count()};
+        best = std::min(best, ms);
+        total += ms;
+    }
+    std::printf("%-34s %9.3f %9.3f\n", name, best, total / repetitions);
+}
+
+} // namespace
+
+int main() {
+    const glb::mp::cpp_int bound{glb::mp::pow(glb::mp::cpp_int{2}, glb::maxB2) - 1};
+    if (glb::mp::msb(bound) + 1 != glb::maxB2) {
+        std::printf("old bound is %llu bits wide, not maxB2\n",
+                    static_cast<unsigned long long>(glb::mp::msb(bound) + 1));
+        return 1;
+    }
+    std::printf("%-34s %9s %9s\n", "startup work", "best ms", "avg ms");
+    report("before: mp::pow bound + 2 indices", [] {
+        const glb::mp::cpp_int maxImgIdx{glb::mp::pow(glb::mp::cpp_int{2}, glb::maxB2) - 1};
+        const glb::ImageIndex imgIdx{}, jumpIntervalIdx{};
+        return static_cast<std::uint64_t>(maxImgIdx & 0xFF) + imgIdx.bytes()[0] + jumpIntervalIdx.bytes()[0];
+    });
+    report("after: 2 indices", [] {
+        const glb::ImageIndex imgIdx{}, jumpIntervalIdx{};
+        return std::uint64_t{imgIdx.bytes()[0]} + jumpIntervalIdx.bytes()[0];
+    });
+    return 0;
+}
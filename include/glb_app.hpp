@@ -1,9 +1,10 @@
 #pragma once
 
-#include <boost/multiprecision/cpp_dec_float.hpp>
-#include <boost/multiprecision/cpp_int.hpp>
-#include <boost/multiprecision/detail/default_ops.hpp>
-#include <climits>
+#include "glb_common.hpp"
+#include "glb_index.hpp"
+#include "glb_interval.hpp"
+#include "glb_render.hpp"
+#include "glb_upload.hpp"
 #include <cstddef>
 #include <glad/glad.h>
 #include <hello_imgui/runner_params.h>
@@ -13,39 +14,21 @@
 
 namespace glb {
 
-constexpr const std::uint64_t imgWidth{1280};
-constexpr const std::uint64_t imgHeight{720};
-constexpr const std::uint64_t imgCh{3};
-namespace mp = boost::multiprecision;
-
-enum class SpatialInterpretation : int { INTERLEAVED, INTERLEAVED_REVERSED, PLANAR, PLANAR_REVERSED, GRAY_CODE, COUNT };
-
-enum class ColorSpaceInterpretation : int { RGB, HSV, YCBCR, COUNT };
-
-constexpr const char *spGetStr(SpatialInterpretation sp) {
-    switch (sp) {
-    case SpatialInterpretation::INTERLEAVED: return "Interleaved";
-    case SpatialInterpretation::INTERLEAVED_REVERSED: return "Reversed Interleaved";
-    case SpatialInterpretation::PLANAR: return "Planar";
-    case SpatialInterpretation::PLANAR_REVERSED: return "Reversed Planar";
-    case SpatialInterpretation::GRAY_CODE: return "Gray Code";
-    default: return "";
-    }
-}
-
-constexpr const char *clrGetStr(ColorSpaceInterpretation clr) {
-    switch (clr) {
-    case ColorSpaceInterpretation::RGB: return "RGB";
-    case ColorSpaceInterpretation::YCBCR: return "YCbCr";
-    case ColorSpaceInterpretation::HSV: return "HSV";
-    default: return "";
-    }
-}
-
 struct TextureData {
     std::vector<std::uint8_t> texture{};
+    const std::uint8_t *source{}; // What gets uploaded, either texture or the index bytes themselves.
+    std::vector<ByteRange> dirty{}; // Byte ranges of source not uploaded yet.
+    std::uint64_t drawnIdxVersion{0};
+    std::uint64_t drawnModeVersion{UINT64_MAX}; // Nothing drawn yet.
     GLuint textureId{};
-    TextureData() : texture(std::vector<std::uint8_t>(imgWidth * imgHeight * imgCh)) {};
+    Renderer renderer{};
+    TextureData() : texture(std::vector<std::uint8_t>(imgWidth * imgHeight * imgCh)), source(texture.data()) {};
+};
+
+// CPU time of the last frame that had something to show, per stage.
+struct FrameTiming {
+    float renderMs{};
+    float uploadMs{};
 };
 
 struct Notification {
@@ -59,19 +42,21 @@ struct ApplicationState {
     const std::uint64_t minSlider{0};
     const std::uint64_t maxCoarseSlider{UINT64_MAX / 2};
     const std::uint64_t maxJumpIntervalSlider{6'658'301}; // We jump exactly 1x10^6,658,301 at maximum.
-    const mp::cpp_int maxImgIdx{mp::pow(mp::cpp_int{2}, imgWidth *imgHeight *imgCh *CHAR_BIT) - 1};
     int spInterp{static_cast<int>(SpatialInterpretation::INTERLEAVED)};
     int clrInterp{static_cast<int>(ColorSpaceInterpretation::RGB)};
-    std::size_t totalLimbs{};
-    mp::cpp_int imgIdx{};
-    mp::cpp_int jumpIntervalIdx{};
+    std::uint64_t modeVersion{0}; // Bumped whenever spInterp or clrInterp changes.
+    ImageIndex imgIdx{};
+    ImageIndex jumpIntervalIdx{};
     std::uint64_t jumpSliderIdx{};
+    std::uint64_t jumpRequestedIdx{}; // Last position handed to the interval engine.
     std::uint64_t coarseSliderIdx{};
+    bool coarseNoiseReady{false}; // The lower bits were filled for the current coarse slider drag.
+    std::uint64_t seed{}; // Key of the last lucky image, which stays on screen while imgIdx is at seedIdxVersion.
+    std::uint64_t seedIdxVersion{UINT64_MAX};
     std::string path{};
     TextureData textureData{};
+    FrameTiming timing{};
     bool showPanels{true};
-    bool shouldClearSentinel{};
-    std::uint8_t executeIntervalCalculation{0};
 };
 
 class Application {
@@ -79,11 +64,14 @@ class Application {
     Notification notif{};
     bool fWndActive;
     ApplicationState state{};
+    IntervalEngine intervalEngine{};
+    TextureUploader uploader{};
     const std::string title{"Gallery of Babel"};
     HelloImGui::RunnerParams rParams{};
     void updateTexture();
     void postInit();
     void randomGen();
+    void seedGen(std::uint64_t seed);
     void controlWindow();
     void additionalControlWindow();
     void update();
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace glb {
+
+/*
+    Arbitrary-size natural number as little-endian 64-bit limbs, used where values grow past
+    what a single step of ImageIndex arithmetic needs, i.e. building powers of ten.
+    Multiplication picks schoolbook, Karatsuba or a number-theoretic transform by size.
+*/
+struct BigNat {
+    std::vector<std::uint64_t> limbs{};
+    void normalize();
+    bool isZero() const { return limbs.empty(); }
+};
+
+BigNat mul(const BigNat &a, const BigNat &b);
+BigNat square(const BigNat &a);
+void mulSmall(BigNat &a, std::uint64_t b);
+
+} // namespace glb
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <stdlib.h>
+#endif
+
+namespace glb {
+
+constexpr const std::uint64_t imgWidth{1280};
+constexpr const std::uint64_t imgHeight{720};
+constexpr const std::uint64_t imgCh{3};
+constexpr const std::uint64_t maxB2{imgWidth * imgHeight * imgCh * CHAR_BIT}; // Number of bits in a 720p image.
+namespace mp = boost::multiprecision;
+
+// Half-open range of byte offsets into an image-sized buffer.
+struct ByteRange {
+    std::size_t begin{};
+    std::size_t end{};
+    bool empty() const { return begin >= end; }
+    void merge(const ByteRange &other) {
+        if (other.empty()) {
+            return;
+        }
+        if (empty()) {
+            *this = other;
+            return;
+        }
+        begin = std::min(begin, other.begin);
+        end = std::max(end, other.end);
+    }
+};
+
+inline std::uint64_t bswap64(std::uint64_t value) {
+#ifdef _MSC_VER
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+// Full 128-bit product of a and b, the low half returned and the high half in hi.
+inline std::uint64_t mulWide(std::uint64_t a, std::uint64_t b, std::uint64_t &hi) {
+#ifdef __SIZEOF_INT128__
+    const unsigned __int128 p{static_cast<unsigned __int128>(a) * b};
+    hi = static_cast<std::uint64_t>(p >> 64);
+    return static_cast<std::uint64_t>(p);
+#else
+    return _umul128(a, b, &hi);
+#endif
+}
+
+} // namespace glb
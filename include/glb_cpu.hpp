@@ -0,0 +1,29 @@
+#pragma once
+
+namespace glb {
+
+// Instruction set tiers the kernels come in, each one implying all tiers below it.
+enum class CpuTier : int { SCALAR, SSE2, SSSE3, AVX2, AVX512, COUNT };
+
+constexpr const char *tierGetStr(CpuTier tier) {
+    switch (tier) {
+    case CpuTier::SCALAR: return "Scalar";
+    case CpuTier::SSE2: return "SSE2";
+    case CpuTier::SSSE3: return "SSSE3";
+    case CpuTier::AVX2: return "AVX2";
+    case CpuTier::AVX512: return "AVX-512";
+    default: return "";
+    }
+}
+
+// The best tier this CPU and OS support, from CPUID. AVX-512 here means F and BW.
+CpuTier detectedTier();
+
+/*
+    The tier kernels are picked for, fixed at first use. Setting GLB_CPU_TIER to scalar, sse2,
+    ssse3, avx2 or avx512 caps it below what was detected, to compare the tiers on one machine.
+    Asking for more than the CPU has, or anything else, is ignored.
+*/
+CpuTier cpuTier();
+
+} // namespace glb
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "glb_bignum.hpp"
+#include "glb_common.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace glb {
+
+/*
+    Fixed-width unsigned integer of exactly maxB2 bits, an index into the space of all images.
+    Arithmetic happens in place on an aligned limb array and saturates at 0 and 2^maxB2 - 1,
+    so stepping through images never allocates.
+
+    The limbs are kept in the same big-endian byte order as an interleaved RGB texture:
+    byte 0 is the most significant and the last limb in memory is the least significant.
+    Arithmetic byte-swaps each word on the way in and out, which means bytes() *is* the
+    image and can be handed to the GPU as is.
+
+    Every mutation also records which bytes it actually changed, so that a small step only
+    costs redrawing the few pixels it touched. takeDirty() hands that range over and resets it,
+    version() changes whenever it grows and is cheap enough to poll every frame.
+*/
+class ImageIndex {
+  public:
+    using Limb = std::uint64_t;
+    static constexpr const std::size_t limbBits{sizeof(Limb) * CHAR_BIT};
+    static constexpr const std::size_t limbCount{maxB2 / limbBits};
+    static constexpr const std::size_t byteCount{maxB2 / CHAR_BIT};
+    static constexpr const std::size_t limbAlignment{64};
+    static_assert(maxB2 % limbBits == 0, "Index width must be a whole number of limbs.");
+
+  private:
+    struct AlignedDelete {
+        void operator()(Limb *ptr) const;
+    };
+    std::unique_ptr<Limb[], AlignedDelete> data;
+    std::size_t used{0}; // Upper bound on the number of significant limbs, counted from the end.
+    ByteRange dirty{};
+    std::uint64_t generation{0};
+    void touch(ByteRange range) {
+        if (!range.empty()) {
+            dirty.merge(range);
+            ++generation;
+        }
+    }
+    void markTail(std::size_t n) { touch(ByteRange{byteCount - n * sizeof(Limb), byteCount}); }
+    void markChanged(std::size_t fromEnd, Limb before, Limb after);
+    // range is relative to the start of the last n limbs.
+    void touchTail(std::size_t n, ByteRange range) {
+        const std::size_t first{byteCount - n * sizeof(Limb)};
+        touch(ByteRange{first + range.begin, first + range.end});
+    }
+    Limb *tail(std::size_t n) { return data.get() + (limbCount - n); }
+    const Limb *tail(std::size_t n) const { return data.get() + (limbCount - n); }
+
+  public:
+    void addSaturate(const ImageIndex &rhs);
+    void subSaturate(const ImageIndex &rhs);
+    // this += k * rhs and this -= k * rhs in a single pass over rhs, saturating the same way.
+    void addScaled(const ImageIndex &rhs, Limb k);
+    void subScaled(const ImageIndex &rhs, Limb k);
+    void assign(const mp::cpp_int &value);
+    void assign(const BigNat &value);
+    void assignBytes(const std::uint8_t *src, std::size_t size);
+    // Every byte from the Philox stream for key, see philoxFill. The same key always gives the same index.
+    void assignRandom(std::uint64_t key);
+    void clear();
+    ByteRange takeDirty() { return std::exchange(dirty, ByteRange{}); }
+    std::uint64_t version() const { return generation; }
+    mp::cpp_int toCppInt() const;
+    // i-th least significant limb, in native byte order.
+    Limb limb(std::size_t i) const { return bswap64(data[limbCount - 1 - i]); }
+    // Overwrites the i-th least significant limb in O(1), marking only the bytes that change.
+    void setLimb(std::size_t i, Limb value);
+    std::uint8_t *bytes() { return reinterpret_cast<std::uint8_t *>(data.get()); }
+    const std::uint8_t *bytes() const { return reinterpret_cast<const std::uint8_t *>(data.get()); }
+    bool operator==(const ImageIndex &rhs) const;
+    ImageIndex();
+    ImageIndex(const ImageIndex &other);
+    ImageIndex &operator=(const ImageIndex &other);
+    ImageIndex(ImageIndex &&) noexcept = default;
+    ImageIndex &operator=(ImageIndex &&other) noexcept;
+};
+
+/*
+    Writes value as exactly ImageIndex::byteCount big-endian bytes, right-aligned and zero padded,
+    unlike mp::export_bits which drops leading zero bytes. Values wider than maxB2 saturate.
+*/
+void exportFixed(const mp::cpp_int &value, std::uint8_t *dst);
+
+} // namespace glb
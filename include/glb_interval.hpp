@@ -0,0 +1,49 @@
+#pragma once
+
+#include "glb_index.hpp"
+#include "glb_powcache.hpp"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace glb {
+
+struct IntervalJob {
+    std::uint64_t exponent{};
+    std::atomic<float> progress{0.0f};
+    std::atomic<bool> finished{false};
+    bool succeeded{false}; // Published by finished.
+    ImageIndex result{};
+};
+
+/*
+    Computes 10^n for the jump interval slider on a worker thread. A new request cancels the
+    one in flight; the caller keeps using its previous interval until poll() swaps the
+    finished one in. The checkpoint powers 10^(2^k) go through a PowerCache, so any slider
+    position only costs multiplying together the ones its binary digits select.
+*/
+class IntervalEngine {
+  private:
+    struct Worker {
+        std::shared_ptr<IntervalJob> job{};
+        std::jthread thread{};
+    };
+    PowerCache cache{}; // Declared first so that it outlives the workers using it.
+    Worker current{};
+    std::vector<Worker> retired{}; // Cancelled, but possibly still inside a multiplication.
+    static void compute(std::stop_token stop, std::shared_ptr<IntervalJob> job, PowerCache *cache);
+
+  public:
+    void openCache(const std::filesystem::path &path);
+    void request(std::uint64_t exponent);
+    bool poll(ImageIndex &interval);
+    bool busy() const;
+    float progress() const;
+    std::uint64_t target() const;
+};
+
+} // namespace glb
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace glb {
+
+/*
+    A whole file mapped read-only, through CreateFileMapping on Windows and mmap elsewhere. The
+    file stays open for writing by others, so a cache can append to a file it has mapped; the
+    view keeps the size the file had when it was opened.
+*/
+class MappedFile {
+  private:
+    const void *view{};
+    std::size_t bytes{};
+#ifdef _WIN32
+    void *fileHandle{};
+    void *mappingHandle{};
+#endif
+
+  public:
+    // Replaces any previous mapping. Fails for missing or empty files.
+    bool open(const std::filesystem::path &path);
+    void close();
+    const void *data() const { return view; }
+    std::size_t size() const { return bytes; }
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+};
+
+} // namespace glb
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "glb_common.hpp"
+#include "glb_mapping.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace glb {
+
+/*
+    A spatial layout given as a permutation of the imgWidth * imgHeight pixels: texture pixel q
+    shows index pixel source()[q], and index pixel n lands on texture pixel order()[n].
+    Rendering gathers through source(), working out what a change redraws goes through order().
+
+    A user layout is a .perm file of exactly that many little-endian uint32 source entries,
+    mapped read-only and used in place. It is rejected unless every pixel appears exactly once.
+*/
+class PixelPermutation {
+  private:
+    std::vector<std::uint32_t> owned{};
+    std::vector<std::uint32_t> inverse{};
+    const std::uint32_t *table{};
+    MappedFile file{};
+    bool invert();
+    void close();
+
+  public:
+    static constexpr const std::size_t pixelCount{imgWidth * imgHeight};
+    const std::uint32_t *source() const { return table; }
+    const std::uint32_t *order() const { return inverse.data(); }
+    // Takes a layout as the texture pixel of every index pixel in turn, the way curves are drawn.
+    void assignOrder(std::vector<std::uint32_t> curve);
+    bool map(const std::filesystem::path &path);
+    PixelPermutation() = default;
+    PixelPermutation(const PixelPermutation &) = delete;
+    PixelPermutation &operator=(const PixelPermutation &) = delete;
+    ~PixelPermutation();
+};
+
+// Built once on first use, from whichever thread gets there first, and kept for the session.
+const PixelPermutation &hilbertPermutation();
+const PixelPermutation &mortonPermutation();
+const PixelPermutation &tiledPermutation();
+
+/*
+    The layout last loaded with loadCustomPermutation, the identity until then. Loading publishes
+    a new layout atomically; a snapshot taken before stays valid, and keeps its file mapped, for
+    as long as it is held.
+*/
+std::shared_ptr<const PixelPermutation> customPermutation();
+bool loadCustomPermutation(const std::filesystem::path &path);
+
+} // namespace glb
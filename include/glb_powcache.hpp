@@ -0,0 +1,51 @@
+#pragma once
+
+#include "glb_bignum.hpp"
+#include "glb_mapping.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+
+namespace glb {
+
+/*
+    Persistent cache of powers of ten for the interval slider, holding the checkpoint powers
+    10^(2^k) every other power is built from. The file is memory-mapped read-only at startup and
+    only ever appended to, every record carries its own checksum and is validated before use.
+    Both the file and the in-memory copies of new entries are capped at a fixed byte budget.
+    Safe to use from several interval workers at once.
+*/
+class PowerCache {
+  public:
+    struct Record {
+        std::uint64_t exponent{};
+        const std::uint64_t *limbs{};
+        std::size_t limbCount{};
+        bool validated{};
+    };
+
+  private:
+    std::mutex mutex{};
+    std::filesystem::path filePath{};
+    MappedFile file{};
+    std::map<std::uint64_t, Record> mapped{};
+    std::map<std::uint64_t, BigNat> fresh{}; // Computed this session and written to the file.
+    std::uintmax_t fileBytes{}; // Mapped plus appended, stores stop once the budget is reached.
+    void close();
+
+  public:
+    void open(const std::filesystem::path &path);
+    std::optional<BigNat> find(std::uint64_t exponent);
+    std::optional<std::uint64_t> floorExponent(std::uint64_t exponent);
+    // Keeps value if exponent is a power of two and it fits the budget, ignores it otherwise.
+    void store(std::uint64_t exponent, const BigNat &value);
+    PowerCache() = default;
+    PowerCache(const PowerCache &) = delete;
+    PowerCache &operator=(const PowerCache &) = delete;
+    ~PowerCache();
+};
+
+} // namespace glb
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "glb_common.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace glb {
+
+enum class SpatialInterpretation : int {
+    INTERLEAVED,
+    INTERLEAVED_REVERSED,
+    PLANAR,
+    PLANAR_REVERSED,
+    GRAY_CODE,
+    BIT_PLANAR,
+    BIT_INTERLEAVED,
+    HILBERT,
+    MORTON,
+    TILED,
+    CUSTOM,
+    COUNT
+};
+
+enum class ColorSpaceInterpretation : int { RGB, HSV, YCBCR, COUNT };
+
+constexpr const char *spGetStr(SpatialInterpretation sp) {
+    switch (sp) {
+    case SpatialInterpretation::INTERLEAVED: return "Interleaved";
+    case SpatialInterpretation::INTERLEAVED_REVERSED: return "Reversed Interleaved";
+    case SpatialInterpretation::PLANAR: return "Planar";
+    case SpatialInterpretation::PLANAR_REVERSED: return "Reversed Planar";
+    case SpatialInterpretation::GRAY_CODE: return "Gray Code";
+    case SpatialInterpretation::BIT_PLANAR: return "Bit Planes";
+    case SpatialInterpretation::BIT_INTERLEAVED: return "Bit Interleaved";
+    case SpatialInterpretation::HILBERT: return "Hilbert Curve";
+    case SpatialInterpretation::MORTON: return "Z-Order Curve";
+    case SpatialInterpretation::TILED: return "Tiled";
+    case SpatialInterpretation::CUSTOM: return "Custom Permutation";
+    default: return "";
+    }
+}
+
+constexpr const char *clrGetStr(ColorSpaceInterpretation clr) {
+    switch (clr) {
+    case ColorSpaceInterpretation::RGB: return "RGB";
+    case ColorSpaceInterpretation::YCBCR: return "YCbCr";
+    case ColorSpaceInterpretation::HSV: return "HSV";
+    default: return "";
+    }
+}
+
+// Sorts and joins overlapping or touching ranges in place, dropping empty ones.
+void coalesce(std::vector<ByteRange> &ranges);
+
+/*
+    Draws (index, spatial, color) triples into caller-owned buffers of imgWidth * imgHeight * imgCh
+    bytes. A renderer owns all of its scratch memory and renderers share nothing but read-only
+    layout tables, so any number of them can run at once on different threads, each used by one
+    thread at a time. A custom permutation loaded while CUSTOM is being rendered takes effect
+    from the next call, each call draws with the layout it started with.
+*/
+class Renderer {
+  public:
+    // Buffers reused by every call, so that once they have grown redrawing allocates nothing.
+    struct Scratch {
+        std::vector<std::uint8_t> block{}; // Channel rows being converted.
+        std::vector<ByteRange> spatial{}; // Bytes of the spatial image to redraw.
+        std::vector<ByteRange> runs{}; // The same as pixel runs within the planes.
+        std::vector<ByteRange> written{}; // What the last call returned.
+    };
+
+  private:
+    Scratch scratch{};
+
+  public:
+    Renderer();
+    /*
+        Redraws the part of dst that depends on the index bytes idx[changed], reading the index
+        once and writing final pixels once. Work is split into pixel runs, each gathered a row
+        at a time into the three channels, converted while still in cache and stored.
+        Returns the byte ranges of dst whose contents may have changed, valid until the next call.
+    */
+    const std::vector<ByteRange> &render(
+        SpatialInterpretation sp, ColorSpaceInterpretation clr, const std::uint8_t *idx, ByteRange changed,
+        std::uint8_t *dst
+    );
+    const std::vector<ByteRange> &renderAll(
+        SpatialInterpretation sp, ColorSpaceInterpretation clr, const std::uint8_t *idx, std::uint8_t *dst
+    );
+};
+
+} // namespace glb
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "glb_common.hpp"
+#include <array>
+#include <cstdint>
+#include <glad/glad.h>
+#include <vector>
+
+namespace glb {
+
+enum class UploadPath : int { PERSISTENT, MAPPED, DIRECT };
+
+constexpr const char *uploadGetStr(UploadPath path) {
+    switch (path) {
+    case UploadPath::PERSISTENT: return "Persistent PBO";
+    case UploadPath::MAPPED: return "Mapped PBO";
+    case UploadPath::DIRECT: return "Direct";
+    default: return "";
+    }
+}
+
+/*
+    Streams dirty rows into the texture through a ring of pixel buffer objects, so that
+    glTexSubImage2D returns right away and the copy into the texture happens on the GPU's time.
+    Picks the best path the context supports: one persistently mapped buffer split into slots
+    (GL 4.4 / ARB_buffer_storage), buffers mapped per upload (GL 3.0), or plain client memory
+    uploads. Software rasterizers such as llvmpipe end up on whichever they advertise, and any
+    mapping failure drops to the next path down. A slot the GPU has not released in time, or
+    whose fence fails, is skipped for that frame in favour of a direct upload.
+*/
+class TextureUploader {
+  private:
+    static constexpr const std::size_t slotCount{3};
+    struct Slot {
+        GLuint buffer{};
+        std::uint8_t *mapped{}; // Persistent path only.
+        GLsync fence{};
+    };
+    std::array<Slot, slotCount> slots{};
+    std::size_t next{0};
+    GLuint texture{};
+    UploadPath path{UploadPath::DIRECT};
+    bool createPersistent();
+    bool createMapped();
+    std::uint8_t *acquire(Slot &slot);
+    void upload(std::uintptr_t base, const std::vector<ByteRange> &rows);
+
+  public:
+    /*
+        best caps the path from above, so that the fallbacks can be measured on hardware that
+        does better. Setting GLB_UPLOAD_PATH to persistent, mapped or direct caps it the same way.
+    */
+    void init(GLuint textureId, UploadPath best = UploadPath::PERSISTENT);
+    // rows are texture rows, coalesced. src is the full image.
+    void submit(const std::uint8_t *src, const std::vector<ByteRange> &rows);
+    void destroy();
+    UploadPath activePath() const { return path; }
+};
+
+} // namespace glb
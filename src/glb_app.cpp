@@ -7,17 +7,13 @@
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include "stb_image_resize2.h"
 
-#define cimg_display 0
-#include "CImg.h"
 #include "glb_app.hpp"
+#include "glb_cpu.hpp"
+#include "glb_kernels.hpp"
+#include "glb_permutation.hpp"
+#include "glb_upload.hpp"
 #include <algorithm>
-#include <boost/multiprecision/cpp_dec_float.hpp>
-#include <boost/multiprecision/cpp_int.hpp>
-#include <boost/multiprecision/cpp_int/import_export.hpp>
-#include <boost/multiprecision/detail/default_ops.hpp>
-#include <boost/multiprecision/detail/min_max.hpp>
 #include <chrono>
-#include <climits>
 #include <cstdint>
 #include <filesystem>
 #include <format>
@@ -45,20 +41,23 @@ namespace glb {
 constexpr const int rgbaChannels{4};
 constexpr const int rgbChannels{3};
 constexpr const int icoSize{32};
-constexpr const std::uint64_t maxB2{22'118'400}; // 1280 * 720 * 8 * 3, number of bits in a 720p image.
 
 namespace {
 
-std::filesystem::path getAssetDir() {
+std::filesystem::path getExecDir() {
     std::string execDir{};
     execDir.resize(512);
     GetModuleFileNameA(NULL, execDir.data(), 512);
     std::filesystem::path execPath{execDir};
     execPath.remove_filename();
-    execPath.append("assets\\");
     return execPath;
 }
 
+std::filesystem::path getAssetDir() { return getExecDir() / "assets"; }
+
+constexpr const std::size_t rowBytes{imgWidth * imgCh};
+constexpr const std::size_t textureBytes{rowBytes * imgHeight};
+
 } // namespace
 
 void Application::postInit() {
@@ -94,79 +93,35 @@ void Application::postInit() {
         GL_TEXTURE_2D, 0, GL_RGB, imgWidth, imgHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, state.textureData.texture.data()
     );
     glBindTexture(GL_TEXTURE_2D, 0);
+    uploader.init(state.textureData.textureId);
 };
 
 void Application::updateTexture() {
-    static mp::cpp_int cachedIdx{state.imgIdx};
-    static SpatialInterpretation cachedSp{state.spInterp};
-    static ColorSpaceInterpretation cachedClr{state.clrInterp};
-    static std::vector<std::uint8_t> exportBuffer(imgHeight * imgWidth * imgCh);
-    if (cachedIdx == state.imgIdx && cachedSp == static_cast<SpatialInterpretation>(state.spInterp) &&
-        cachedClr == static_cast<ColorSpaceInterpretation>(state.clrInterp)) {
+    TextureData &textureData{state.textureData};
+    const bool modeChanged{textureData.drawnModeVersion != state.modeVersion};
+    if (!modeChanged && textureData.drawnIdxVersion == state.imgIdx.version()) {
         return;
     }
-    auto interleavedToPlanar{[&] {
-        const std::size_t imgSize{imgHeight * imgWidth};
-        for (std::size_t i = 0; i < imgSize; ++i) {
-            for (std::size_t j = 0; j < imgCh; ++j) {
-                const std::uint8_t value{exportBuffer[i * imgCh + j]};
-                state.textureData.texture[imgSize * j + i] = value;
-            }
-        }
-    }};
-    switch (static_cast<SpatialInterpretation>(state.spInterp)) {
-    case SpatialInterpretation::INTERLEAVED:
-        mp::export_bits(state.imgIdx, exportBuffer.begin(), CHAR_BIT);
-        exportBuffer[0] &= ~(state.shouldClearSentinel ? 0b1000'0000 : 0);
-        state.textureData.texture = exportBuffer;
-        break;
-    case SpatialInterpretation::INTERLEAVED_REVERSED:
-        mp::export_bits(state.imgIdx, exportBuffer.begin(), CHAR_BIT);
-        exportBuffer[0] &= ~(state.shouldClearSentinel ? 0b1000'0000 : 0);
-        state.textureData.texture = exportBuffer;
-        std::reverse(state.textureData.texture.begin(), state.textureData.texture.end());
-        break;
-    case SpatialInterpretation::PLANAR:
-        mp::export_bits(state.imgIdx, exportBuffer.begin(), CHAR_BIT);
-        exportBuffer[0] &= ~(state.shouldClearSentinel ? 0b1000'0000 : 0);
-        interleavedToPlanar();
-        break;
-    case SpatialInterpretation::PLANAR_REVERSED:
-        mp::export_bits(state.imgIdx, exportBuffer.begin(), CHAR_BIT);
-        exportBuffer[0] &= ~(state.shouldClearSentinel ? 0b1000'0000 : 0);
-        interleavedToPlanar();
-        std::reverse(state.textureData.texture.begin(), state.textureData.texture.end());
-        break;
-    case SpatialInterpretation::GRAY_CODE: {
-        /*
-            Bypasses sentinel bit correction logic. Left as is, as
-            Gray code scrambles the index itself, and does not operate
-            on some other representation of it like the other modes.
-            mp::export_bits always "efficiently" skips leading zeroes.
-            Visually flushing the image to the left.
-        */
-        const mp::cpp_int gImg{state.imgIdx ^ (state.imgIdx >> 1)};
-        mp::export_bits(gImg, state.textureData.texture.begin(), CHAR_BIT);
-        break;
-    }
-    default: break;
-    }
-    using namespace cimg_library;
-    CImg<std::uint8_t> img{state.textureData.texture.data(), imgWidth, imgHeight, 1, imgCh, true};
-    switch (static_cast<ColorSpaceInterpretation>(state.clrInterp)) {
-    case ColorSpaceInterpretation::HSV: {
-        img.HSVtoRGBModified();
-        break;
-    }
-    case ColorSpaceInterpretation::YCBCR: {
-        img.YCbCrtoRGB();
-        break;
+    ByteRange changed{state.imgIdx.takeDirty()};
+    if (modeChanged) {
+        changed = ByteRange{0, textureBytes};
     }
-    default: break;
+    textureData.drawnIdxVersion = state.imgIdx.version();
+    textureData.drawnModeVersion = state.modeVersion;
+    const SpatialInterpretation sp{static_cast<SpatialInterpretation>(state.spInterp)};
+    const ColorSpaceInterpretation clr{static_cast<ColorSpaceInterpretation>(state.clrInterp)};
+    // The index is stored in texture byte order, so it already is the interleaved image.
+    const std::uint8_t *idxBytes{state.imgIdx.bytes()};
+    if (sp == SpatialInterpretation::INTERLEAVED && clr == ColorSpaceInterpretation::RGB) {
+        textureData.source = idxBytes;
+        textureData.dirty.push_back(changed);
+        return;
     }
-    cachedIdx = state.imgIdx;
-    cachedSp = static_cast<SpatialInterpretation>(state.spInterp);
-    cachedClr = static_cast<ColorSpaceInterpretation>(state.clrInterp);
+    textureData.source = textureData.texture.data();
+    const std::vector<ByteRange> &written{
+        textureData.renderer.render(sp, clr, idxBytes, changed, textureData.texture.data())
+    };
+    textureData.dirty.insert(textureData.dirty.end(), written.begin(), written.end());
 }
 
 void Application::update() {
@@ -176,17 +131,36 @@ void Application::update() {
             window.isVisible = state.showPanels;
         }
     }
+    intervalEngine.poll(state.jumpIntervalIdx);
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point renderStart{Clock::now()};
     updateTexture();
-    glBindTexture(GL_TEXTURE_2D, state.textureData.textureId);
-    glTexSubImage2D(
-        GL_TEXTURE_2D, 0, 0, 0, imgWidth, imgHeight, GL_RGB, GL_UNSIGNED_BYTE, state.textureData.texture.data()
-    );
+    // Only whole rows can be uploaded, so dirty bytes are widened to the rows containing them.
+    std::vector<ByteRange> &dirty{state.textureData.dirty};
+    if (!dirty.empty()) {
+        for (ByteRange &range : dirty) {
+            range = ByteRange{range.begin / rowBytes, (range.end + rowBytes - 1) / rowBytes};
+        }
+        const Clock::time_point uploadStart{Clock::now()};
+        coalesce(dirty);
+        uploader.submit(state.textureData.source, dirty);
+        dirty.clear();
+        const Clock::time_point uploadEnd{Clock::now()};
+        state.timing.renderMs = std::chrono::duration<float, std::milli>(uploadStart - renderStart).count();
+        state.timing.uploadMs = std::chrono::duration<float, std::milli>(uploadEnd - uploadStart).count();
+    }
+    /*
+        Between events the loop sleeps, see the constructor. Background work and fading toasts
+        have no input event to wake it up with, so they keep it running until they are done.
+    */
+    rParams.fpsIdling.enableIdling = !intervalEngine.busy() && !notif.isActive;
     ImDrawList *bgDrawList{ImGui::GetBackgroundDrawList(ImGui::GetMainViewport())};
     bgDrawList->AddImage(static_cast<ImTextureID>(state.textureData.textureId), ImVec2{0, 0}, ImVec2{1280, 720});
     renderNotif();
 }
 
 void Application::beforeExit() {
+    uploader.destroy();
     if (state.textureData.textureId) {
         glDeleteTextures(1, &state.textureData.textureId);
         state.textureData.textureId = 0;
@@ -198,33 +172,44 @@ void Application::additionalControlWindow() {
         return;
     }
     ImGui::PushItemWidth(-1);
-    if (ImGui::SliderScalar(
-            "##", ImGuiDataType_::ImGuiDataType_U64, &state.jumpSliderIdx, &state.minSlider,
-            &state.maxJumpIntervalSlider, std::format("Interval: 1x10^{}", state.jumpSliderIdx).c_str()
-        ) ||
-        state.executeIntervalCalculation != 0) {
-        // We have to quit halfway before the UI freezes when it goes through with the calculation.
-        if (state.jumpSliderIdx > 500'000 && !state.executeIntervalCalculation) {
-            toastNotif(
-                "WARNING: Larger interval values take significantly longer to calculate...\nUI will be unresponsive.",
-                3.0f
-            );
-            state.executeIntervalCalculation = 3;
-        } else if (state.executeIntervalCalculation == 1 || state.jumpSliderIdx < 500'000) {
-            state.jumpIntervalIdx = mp::pow(mp::cpp_int{10}, state.jumpSliderIdx);
-            state.executeIntervalCalculation--;
-        } else if (state.executeIntervalCalculation != 1) {
-            state.executeIntervalCalculation--;
-        }
-    }
-    ImGui::SliderInt(
-        "##x", &state.spInterp, 0, static_cast<int>(SpatialInterpretation::COUNT) - 1,
-        spGetStr(static_cast<SpatialInterpretation>(state.spInterp))
-    );
-    ImGui::SliderInt(
-        "##xx", &state.clrInterp, 0, static_cast<int>(ColorSpaceInterpretation::COUNT) - 1,
-        clrGetStr(static_cast<ColorSpaceInterpretation>(state.clrInterp))
+    const bool jumpPending{state.jumpSliderIdx != state.jumpRequestedIdx};
+    ImGui::SliderScalar(
+        "##", ImGuiDataType_::ImGuiDataType_U64, &state.jumpSliderIdx, &state.minSlider, &state.maxJumpIntervalSlider,
+        std::format("Interval: 1x10^{}{}", state.jumpSliderIdx, jumpPending ? " (release to apply)" : "").c_str()
     );
+    /*
+        Every request starts a worker and a full-size result, so nothing is requested mid-drag, only
+        the position the slider is let go at. It runs in the background, the previous interval
+        stays in use until this one is done.
+    */
+    if (ImGui::IsItemDeactivatedAfterEdit() && state.jumpSliderIdx != state.jumpRequestedIdx) {
+        state.jumpRequestedIdx = state.jumpSliderIdx;
+        intervalEngine.request(state.jumpSliderIdx);
+    }
+    if (intervalEngine.busy()) {
+        const float progress{intervalEngine.progress()};
+        ImGui::ProgressBar(
+            progress, ImVec2{-1, 0},
+            std::format("Calculating 1x10^{}... {:.0f}%", intervalEngine.target(), progress * 100.0f).c_str()
+        );
+    }
+    if (ImGui::SliderInt(
+            "##x", &state.spInterp, 0, static_cast<int>(SpatialInterpretation::COUNT) - 1,
+            spGetStr(static_cast<SpatialInterpretation>(state.spInterp))
+        )) {
+        ++state.modeVersion;
+    }
+    if (ImGui::SliderInt(
+            "##xx", &state.clrInterp, 0, static_cast<int>(ColorSpaceInterpretation::COUNT) - 1,
+            clrGetStr(static_cast<ColorSpaceInterpretation>(state.clrInterp))
+        )) {
+        ++state.modeVersion;
+    }
+    const std::string timingText{std::format(
+        "Render {:.2f} ms ({}), upload {:.2f} ms ({})", state.timing.renderMs, tierGetStr(cpuTier()),
+        state.timing.uploadMs, uploadGetStr(uploader.activePath())
+    )};
+    ImGui::TextDisabled("%s", timingText.c_str());
     ImGui::PopItemWidth();
 }
 
@@ -253,6 +238,29 @@ void Application::controlWindow() {
         fWndActive = true;
         ImGui::OpenPopup("Image Search");
     }
+    /*
+        A lucky image is nothing but its seed, so the seed is all it takes to keep or share one.
+        Once the index moves elsewhere the field is dimmed, still holding the last seed.
+    */
+    const bool seedShown{state.imgIdx.version() == state.seedIdxVersion};
+    ImGui::SameLine();
+    ImGui::TextDisabled("Seed");
+    ImGui::SameLine();
+    ImGui::PushItemWidth(-1);
+    if (!seedShown) {
+        ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled));
+    }
+    if (ImGui::InputScalar(
+            "##seed", ImGuiDataType_::ImGuiDataType_U64, &state.seed, nullptr, nullptr, nullptr,
+            ImGuiInputTextFlags_EnterReturnsTrue
+        )) {
+        seedGen(state.seed);
+        idxInterpolate();
+    }
+    if (!seedShown) {
+        ImGui::PopStyleColor();
+    }
+    ImGui::PopItemWidth();
     ImGui::PushItemWidth(-1);
     if (ImGui::SliderScalar(
             "##", ImGuiDataType_::ImGuiDataType_U64, &state.coarseSliderIdx, &state.minSlider, &state.maxCoarseSlider,
@@ -260,12 +268,17 @@ void Application::controlWindow() {
         )) {
         /*
             This is such a humongous number you might as well randomly fill in the lower bits, else
-            you'll just see plain black.
+            you'll just see plain black. They are filled once per drag, after that every move only
+            rewrites the top limb, the inverse of idxInterpolate.
         */
-        randomGen();
-        state.imgIdx >>= 64;
-        state.imgIdx |= mp::cpp_int{state.coarseSliderIdx}
-                        << ((mp::msb(state.maxImgIdx) + 1) - (sizeof(std::uint64_t) * CHAR_BIT));
+        if (!state.coarseNoiseReady) {
+            randomGen();
+            state.coarseNoiseReady = true;
+        }
+        state.imgIdx.setLimb(ImageIndex::limbCount - 1, state.coarseSliderIdx << 1);
+    }
+    if (ImGui::IsItemDeactivated()) {
+        state.coarseNoiseReady = false;
     }
     ImGui::PopItemWidth();
     float availableWidth{ImGui::GetContentRegionAvail().x};
@@ -274,13 +287,32 @@ void Application::controlWindow() {
         When set to the absolute maximum, the slider can only affect the lower bits. The cap given by
         min and max would then be left at the bottom, either pure black or white. 
     */
-    if (ImGui::Button("<<", ImVec2{intervalButtonWidth, 0}) || ImGui::IsKeyPressed(ImGuiKey_LeftArrow, true)) {
-        state.imgIdx = mp::max(mp::cpp_int{0}, state.imgIdx - state.jumpIntervalIdx);
-        idxInterpolate();
+    /*
+        Key repeats are counted from the time elapsed, so a slow frame sees several at once. They
+        are summed with the button clicks into one signed step count and applied as a single
+        imgIdx +- steps * interval, leaving nothing queued and only the end result to render.
+        Arrows moving a text cursor or adjusting an active widget belong to that widget instead.
+    */
+    const ImGuiIO &io{ImGui::GetIO()};
+    const bool arrowsFree{!io.WantTextInput && !(io.WantCaptureKeyboard && ImGui::IsAnyItemActive())};
+    std::int64_t steps{
+        arrowsFree ? ImGui::GetKeyPressedAmount(ImGuiKey_RightArrow, io.KeyRepeatDelay, io.KeyRepeatRate) -
+                         ImGui::GetKeyPressedAmount(ImGuiKey_LeftArrow, io.KeyRepeatDelay, io.KeyRepeatRate)
+                   : 0
+    };
+    if (ImGui::Button("<<", ImVec2{intervalButtonWidth, 0})) {
+        --steps;
     }
     ImGui::SameLine();
-    if (ImGui::Button(">>", ImVec2{intervalButtonWidth, 0}) || ImGui::IsKeyPressed(ImGuiKey_RightArrow, true)) {
-        state.imgIdx = mp::min(state.maxImgIdx, state.imgIdx + state.jumpIntervalIdx);
+    if (ImGui::Button(">>", ImVec2{intervalButtonWidth, 0})) {
+        ++steps;
+    }
+    if (steps > 0) {
+        state.imgIdx.addScaled(state.jumpIntervalIdx, static_cast<std::uint64_t>(steps));
+    } else if (steps < 0) {
+        state.imgIdx.subScaled(state.jumpIntervalIdx, static_cast<std::uint64_t>(-steps));
+    }
+    if (steps != 0) {
         idxInterpolate();
     }
     // Weird bug where the window does not appear visible when called on the main update() loop. Hence placed here.
@@ -288,9 +320,11 @@ void Application::controlWindow() {
 }
 
 Application::Application() {
+    intervalEngine.openCache(getExecDir().append("pow10.cache"));
     rParams.callbacks.ShowGui = [this] { update(); };
     rParams.imGuiWindowParams.defaultImGuiWindowType = HelloImGui::DefaultImGuiWindowType::ProvideFullScreenDockSpace;
     rParams.callbacks.PostInit = [this] { postInit(); };
+    rParams.callbacks.BeforeExit = [this] { beforeExit(); };
     rParams.dockingParams.dockingSplits.push_back(
         HelloImGui::DockingSplit{"MainDockSpace", "MainBottom", ImGuiDir_Down, 0.14f}
     );
@@ -312,41 +346,38 @@ Application::Application() {
     aWParams.windowGeometry.fullScreenMode = HelloImGui::FullScreenMode::NoFullScreen;
     aWParams.windowGeometry.sizeAuto = false;
     aWParams.resizable = false;
+
+    /*
+        Nothing animates on its own, so between events the loop blocks waiting for input and only
+        wakes a few times a second. An fpsIdle of 0 would turn idling off altogether. update()
+        switches idling off while background work or a toast needs frames.
+    */
+    rParams.fpsIdling.fpsIdle = 3.0f;
+    rParams.fpsIdling.enableIdling = true;
 }
 
 void Application::run() { HelloImGui::Run(rParams); }
 
 void Application::randomGen() {
-    constexpr const std::size_t uint64Sz{sizeof(std::uint64_t) * CHAR_BIT};
-    const std::size_t totalBits{mp::msb(state.maxImgIdx) + 1};
+    // Only the key is drawn here, the index is its Philox stream written straight into the limbs.
     static std::random_device rd{};
     static std::mt19937_64 gen{rd()};
-    std::vector<std::uint64_t> rdChunks{};
-    rdChunks.resize((mp::msb(state.maxImgIdx) + 1) / uint64Sz);
-    while (true) {
-        /*
-            This stuff only works because we use 1280x720x3, which is divisible by 64.
-            If you do change the resolution, take note of this too.
-        */
-        for (std::uint64_t &chunk : rdChunks) {
-            chunk = gen();
-        }
-        mp::import_bits(state.imgIdx, rdChunks.begin(), rdChunks.end());
-        if (state.imgIdx >= 0 && state.imgIdx <= state.maxImgIdx) {
-            break;
-        }
-    }
+    seedGen(gen());
+}
+
+void Application::seedGen(std::uint64_t seed) {
+    state.seed = seed;
+    state.imgIdx.assignRandom(seed);
+    state.seedIdxVersion = state.imgIdx.version();
 }
 
 void Application::idxInterpolate() {
-    constexpr const std::size_t uint64Sz{sizeof(std::uint64_t) * CHAR_BIT};
-    const std::size_t totalBits{mp::msb(state.maxImgIdx) + 1};
     /*
         Might be fragile. Just take note for possible errors.
         >> 1 is required due to the fact that ImGui uses doubles internally
         and cannot represent all of uint64_t in full precision.
     */
-    state.coarseSliderIdx = ((state.imgIdx >> (totalBits - uint64Sz))).convert_to<std::uint64_t>() >> 1;
+    state.coarseSliderIdx = state.imgIdx.limb(ImageIndex::limbCount - 1) >> 1;
 }
 
 void Application::toastNotif(const std::string &text, const float durationSec) {
@@ -386,8 +417,20 @@ void Application::loadFile() {
     std::filesystem::path filePath{state.path};
     if (!std::filesystem::exists(filePath)) {
         toastNotif("Invalid path.", 2.0f);
+        return;
     }
     std::string extension{filePath.extension().string()};
+    if (extension == ".perm") {
+        // A layout rather than an image: the index stays, only the way it is drawn changes.
+        if (!loadCustomPermutation(filePath)) {
+            toastNotif("Not a permutation of 1280x720 pixels.", 2.0f);
+            return;
+        }
+        toastNotif("Loaded as custom permutation.", 2.0f);
+        state.spInterp = static_cast<int>(SpatialInterpretation::CUSTOM);
+        ++state.modeVersion;
+        return;
+    }
     std::vector<std::uint8_t> idxBuffer(imgWidth * imgHeight * imgCh, 0);
     if (extension == ".png" || extension == ".jpg") {
         toastNotif("Loaded as .png/.jpg.", 2.0f);
@@ -410,10 +453,11 @@ void Application::loadFile() {
                 }
             }
         }
-        std::uint8_t dBit{static_cast<std::uint8_t>((idxBuffer[0] & 0b1000'0000) >> 7)};
-        idxBuffer[0] |= 0b1000'0000;
-        mp::import_bits(state.imgIdx, idxBuffer.begin(), idxBuffer.end());
-        state.shouldClearSentinel = dBit == 0;
+        // Gray code mode shows the encoded index, so the image is the encoding of the index to load.
+        if (static_cast<SpatialInterpretation>(state.spInterp) == SpatialInterpretation::GRAY_CODE) {
+            grayDecode(idxBuffer.data(), idxBuffer.data(), idxBuffer.size());
+        }
+        state.imgIdx.assignBytes(idxBuffer.data(), idxBuffer.size());
     } else {
         std::ifstream fileStream{filePath, std::ios::binary | std::ios::ate};
         std::streamsize fSize{fileStream.tellg()};
@@ -422,7 +466,7 @@ void Application::loadFile() {
             reinterpret_cast<char *>(idxBuffer.data()), std::min(idxBuffer.size(), static_cast<std::size_t>(fSize))
         );
         toastNotif("Loaded as generic binary stream.", 2.0f);
-        mp::import_bits(state.imgIdx, idxBuffer.begin(), idxBuffer.end());
+        state.imgIdx.assignBytes(idxBuffer.data(), idxBuffer.size());
     }
     idxInterpolate();
 }
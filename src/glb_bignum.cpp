@@ -0,0 +1,312 @@
+#include "glb_bignum.hpp"
+#include "glb_common.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace glb {
+
+namespace {
+
+using Limb = std::uint64_t;
+
+// Below these sizes the next simpler algorithm is faster. Karatsuba's is per operand, the NTT's is
+// the product size, both in limbs.
+constexpr const std::size_t karatsubaThreshold{48};
+constexpr const std::size_t nttThreshold{8192};
+
+// ---- Schoolbook & Karatsuba over limb spans. -------------------------------------------------
+
+void mulSchoolbook(Limb *r, const Limb *a, std::size_t an, const Limb *b, std::size_t bn) {
+    std::fill_n(r, an + bn, Limb{0});
+    for (std::size_t i{0}; i < an; ++i) {
+        Limb carry{0};
+        for (std::size_t j{0}; j < bn; ++j) {
+            Limb hi{};
+            Limb lo{mulWide(a[i], b[j], hi)};
+            lo += r[i + j];
+            hi += lo < r[i + j];
+            lo += carry;
+            hi += lo < carry;
+            r[i + j] = lo;
+            carry = hi;
+        }
+        r[i + bn] = carry;
+    }
+}
+
+// r[0, rn) += a[0, an), carry propagates at most up to rn.
+void addInPlace(Limb *r, std::size_t rn, const Limb *a, std::size_t an) {
+    Limb carry{0};
+    std::size_t i{0};
+    for (; i < an; ++i) {
+        const Limb sum{r[i] + a[i]};
+        const Limb out{sum + carry};
+        carry = (sum < r[i]) | (out < sum);
+        r[i] = out;
+    }
+    for (; carry && i < rn; ++i) {
+        carry = ++r[i] == 0;
+    }
+}
+
+// r[0, rn) -= a[0, an), the result must not be negative.
+void subInPlace(Limb *r, std::size_t rn, const Limb *a, std::size_t an) {
+    Limb borrow{0};
+    std::size_t i{0};
+    for (; i < an; ++i) {
+        const Limb diff{r[i] - a[i]};
+        const Limb out{diff - borrow};
+        borrow = (r[i] < a[i]) | (diff < borrow);
+        r[i] = out;
+    }
+    for (; borrow && i < rn; ++i) {
+        borrow = r[i]-- == 0;
+    }
+}
+
+// r[0, 2n) = a[0, n) * b[0, n). scratch needs karatsubaScratch(n) limbs.
+void mulKaratsuba(Limb *r, const Limb *a, const Limb *b, std::size_t n, Limb *scratch) {
+    if (n < karatsubaThreshold) {
+        mulSchoolbook(r, a, n, b, n);
+        return;
+    }
+    const std::size_t lo{n / 2};
+    const std::size_t hi{n - lo};
+    Limb *sa{scratch};
+    Limb *sb{sa + hi + 1};
+    Limb *mid{sb + hi + 1};
+    Limb *next{mid + 2 * (hi + 1)};
+
+    mulKaratsuba(r, a, b, lo, next);
+    mulKaratsuba(r + 2 * lo, a + lo, b + lo, hi, next);
+
+    // (a0 + a1)(b0 + b1) - a0b0 - a1b1 lands at r + lo.
+    std::copy_n(a + lo, hi, sa);
+    std::copy_n(b + lo, hi, sb);
+    sa[hi] = 0;
+    sb[hi] = 0;
+    addInPlace(sa, hi + 1, a, lo);
+    addInPlace(sb, hi + 1, b, lo);
+    mulKaratsuba(mid, sa, sb, hi + 1, next);
+    subInPlace(mid, 2 * (hi + 1), r, 2 * lo);
+    subInPlace(mid, 2 * (hi + 1), r + 2 * lo, 2 * hi);
+    addInPlace(r + lo, 2 * n - lo, mid, std::min(2 * (hi + 1), 2 * n - lo));
+}
+
+std::size_t karatsubaScratch(std::size_t n) {
+    std::size_t total{0};
+    while (n >= karatsubaThreshold) {
+        const std::size_t hi{n - n / 2};
+        total += 4 * (hi + 1);
+        n = hi + 1;
+    }
+    return total;
+}
+
+// ---- Number-theoretic transform modulo the Goldilocks prime 2^64 - 2^32 + 1. ------------------
+
+/*
+    The prime has 2^32-th roots of unity and reduces with shifts and adds only. Inputs are split
+    into 16-bit digits, so a convolution term is at most n * (2^16 - 1)^2 < 2^53 for any transform
+    we can allocate, and fits the modulus without wrapping.
+*/
+constexpr const Limb modP{0xFFFF'FFFF'0000'0001};
+constexpr const Limb epsilon{0xFFFF'FFFF}; // 2^64 mod p.
+constexpr const Limb generator{7};
+constexpr const unsigned digitBits{16};
+constexpr const unsigned digitsPerLimb{64 / digitBits};
+
+// Branch-free: butterfly inputs are effectively random, so any branch here mispredicts half the time.
+inline Limb mask(bool condition) { return Limb{0} - static_cast<Limb>(condition); }
+
+inline Limb addMod(Limb a, Limb b) {
+    const Limb sum{a + b};
+    const Limb out{sum + (mask(sum < a) & epsilon)};
+    return out - (mask(out >= modP) & modP);
+}
+
+inline Limb subMod(Limb a, Limb b) { return (a - b) - (mask(a < b) & epsilon); }
+
+inline Limb mulMod(Limb a, Limb b) {
+    Limb hi{};
+    const Limb lo{mulWide(a, b, hi)};
+    // hi * 2^64 + lo with 2^64 = 2^32 - 1 and 2^96 = -1 (mod p).
+    const Limb hiHi{hi >> 32};
+    const Limb hiLo{hi & epsilon};
+    const Limb t0{(lo - hiHi) - (mask(lo < hiHi) & epsilon)};
+    const Limb t1{hiLo * epsilon};
+    const Limb sum{t0 + t1};
+    const Limb out{sum + (mask(sum < t1) & epsilon)};
+    return out - (mask(out >= modP) & modP);
+}
+
+Limb powMod(Limb base, Limb exponent) {
+    Limb result{1};
+    while (exponent) {
+        if (exponent & 1) {
+            result = mulMod(result, base);
+        }
+        base = mulMod(base, base);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+/*
+    Twiddles for every transform size m <= n laid out back to back: roots[m / 2 + j] = w_m^j for
+    j < m / 2. Each stage then reads its twiddles contiguously instead of striding through one
+    big table, which matters once the subtransforms are small and cache resident.
+*/
+std::vector<Limb> rootTable(std::size_t n, bool inverse) {
+    std::vector<Limb> roots(n);
+    for (std::size_t m{2}; m <= n; m <<= 1) {
+        Limb w{powMod(generator, (modP - 1) / m)};
+        if (inverse) {
+            w = powMod(w, modP - 2);
+        }
+        Limb current{1};
+        for (std::size_t j{0}; j < m / 2; ++j) {
+            roots[m / 2 + j] = current;
+            current = mulMod(current, w);
+        }
+    }
+    return roots;
+}
+
+// Decimation in frequency: natural order in, bit-reversed order out.
+void forwardNtt(Limb *a, std::size_t n, const Limb *roots) {
+    for (std::size_t len{n}; len >= 2; len >>= 1) {
+        const std::size_t half{len / 2};
+        const Limb *tw{roots + half};
+        for (std::size_t start{0}; start < n; start += len) {
+            Limb *lo{a + start};
+            Limb *hi{lo + half};
+            for (std::size_t j{0}; j < half; ++j) {
+                const Limb u{lo[j]}, v{hi[j]};
+                lo[j] = addMod(u, v);
+                hi[j] = mulMod(subMod(u, v), tw[j]);
+            }
+        }
+    }
+}
+
+// Decimation in time: bit-reversed order in, natural order out. Unscaled.
+void inverseNtt(Limb *a, std::size_t n, const Limb *roots) {
+    for (std::size_t len{2}; len <= n; len <<= 1) {
+        const std::size_t half{len / 2};
+        const Limb *tw{roots + half};
+        for (std::size_t start{0}; start < n; start += len) {
+            Limb *lo{a + start};
+            Limb *hi{lo + half};
+            for (std::size_t j{0}; j < half; ++j) {
+                const Limb u{lo[j]}, v{mulMod(hi[j], tw[j])};
+                lo[j] = addMod(u, v);
+                hi[j] = subMod(u, v);
+            }
+        }
+    }
+}
+
+void toDigits(Limb *dst, std::size_t n, const Limb *src, std::size_t sn) {
+    std::size_t k{0};
+    for (std::size_t i{0}; i < sn; ++i) {
+        for (unsigned d{0}; d < digitsPerLimb; ++d) {
+            dst[k++] = (src[i] >> (d * digitBits)) & 0xFFFF;
+        }
+    }
+    std::fill(dst + k, dst + n, Limb{0});
+}
+
+void mulNtt(Limb *r, const Limb *a, std::size_t an, const Limb *b, std::size_t bn) {
+    const std::size_t digits{(an + bn) * digitsPerLimb};
+    const std::size_t n{std::bit_ceil(digits)};
+    const std::vector<Limb> roots{rootTable(n, false)};
+    const std::vector<Limb> invRoots{rootTable(n, true)};
+    std::vector<Limb> fa(n);
+    toDigits(fa.data(), n, a, an);
+    forwardNtt(fa.data(), n, roots.data());
+    if (a == b && an == bn) {
+        for (Limb &x : fa) {
+            x = mulMod(x, x);
+        }
+    } else {
+        std::vector<Limb> fb(n);
+        toDigits(fb.data(), n, b, bn);
+        forwardNtt(fb.data(), n, roots.data());
+        for (std::size_t i{0}; i < n; ++i) {
+            fa[i] = mulMod(fa[i], fb[i]);
+        }
+    }
+    inverseNtt(fa.data(), n, invRoots.data());
+
+    // Scale by 1/n and carry the 53-bit coefficients back into 16-bit digits, then limbs.
+    const Limb nInv{powMod(n, modP - 2)};
+    Limb carry{0};
+    for (std::size_t i{0}; i < an + bn; ++i) {
+        Limb limb{0};
+        for (unsigned d{0}; d < digitsPerLimb; ++d) {
+            carry += mulMod(fa[i * digitsPerLimb + d], nInv);
+            limb |= (carry & 0xFFFF) << (d * digitBits);
+            carry >>= digitBits;
+        }
+        r[i] = limb;
+    }
+}
+
+} // namespace
+
+void BigNat::normalize() {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+
+BigNat mul(const BigNat &a, const BigNat &b) {
+    BigNat result{};
+    if (a.isZero() || b.isZero()) {
+        return result;
+    }
+    const BigNat &big{a.limbs.size() >= b.limbs.size() ? a : b};
+    const BigNat &small{&big == &a ? b : a};
+    const std::size_t bn{big.limbs.size()}, sn{small.limbs.size()};
+    result.limbs.resize(bn + sn);
+    if (sn < karatsubaThreshold) {
+        mulSchoolbook(result.limbs.data(), big.limbs.data(), bn, small.limbs.data(), sn);
+    } else if (bn + sn >= nttThreshold) {
+        mulNtt(result.limbs.data(), big.limbs.data(), bn, small.limbs.data(), sn);
+    } else {
+        // Karatsuba wants equal halves, so the shorter operand is zero-extended.
+        std::vector<Limb> padded(bn, 0);
+        std::copy_n(small.limbs.data(), sn, padded.data());
+        std::vector<Limb> product(2 * bn);
+        std::vector<Limb> scratch(karatsubaScratch(bn));
+        mulKaratsuba(product.data(), big.limbs.data(), padded.data(), bn, scratch.data());
+        std::copy_n(product.data(), bn + sn, result.limbs.data());
+    }
+    result.normalize();
+    return result;
+}
+
+BigNat square(const BigNat &a) { return mul(a, a); }
+
+void mulSmall(BigNat &a, std::uint64_t b) {
+    if (b == 0) {
+        a.limbs.clear();
+        return;
+    }
+    Limb carry{0};
+    for (Limb &limb : a.limbs) {
+        Limb hi{};
+        Limb lo{mulWide(limb, b, hi)};
+        lo += carry;
+        hi += lo < carry;
+        limb = lo;
+        carry = hi;
+    }
+    if (carry) {
+        a.limbs.push_back(carry);
+    }
+}
+
+} // namespace glb
@@ -0,0 +1,96 @@
+#include "glb_cpu.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GLB_X86 1
+#ifdef _MSC_VER
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+namespace glb {
+
+namespace {
+
+CpuTier detect() {
+#ifndef GLB_X86
+    return CpuTier::SCALAR;
+#elif defined(_MSC_VER)
+    int info[4]{};
+    __cpuid(info, 1);
+    const bool sse2{((info[3] >> 26) & 1) != 0};
+    const bool ssse3{((info[2] >> 9) & 1) != 0};
+    // Wider registers also need the OS to save them: YMM state for AVX2, ZMM and opmask state for AVX-512.
+    const bool osxsave{((info[2] >> 27) & 1) != 0};
+    const unsigned long long xcr0{osxsave ? _xgetbv(0) : 0};
+    const bool osAvx{(xcr0 & 0x6) == 0x6};
+    const bool osAvx512{(xcr0 & 0xE6) == 0xE6};
+    __cpuidex(info, 7, 0);
+    const bool avx2{osAvx && ((info[1] >> 5) & 1)};
+    const bool avx512{osAvx512 && ((info[1] >> 16) & 1) && ((info[1] >> 30) & 1)};
+#else
+    __builtin_cpu_init();
+    const bool sse2{__builtin_cpu_supports("sse2") != 0};
+    const bool ssse3{__builtin_cpu_supports("ssse3") != 0};
+    const bool avx2{__builtin_cpu_supports("avx2") != 0};
+    const bool avx512{__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")};
+#endif
+#ifdef GLB_X86
+    if (!sse2) {
+        return CpuTier::SCALAR;
+    }
+    if (!ssse3) {
+        return CpuTier::SSE2;
+    }
+    if (!avx2) {
+        return CpuTier::SSSE3;
+    }
+    return avx512 ? CpuTier::AVX512 : CpuTier::AVX2;
+#endif
+}
+
+std::string tierOverride() {
+#ifdef _MSC_VER
+    char *value{};
+    std::size_t size{};
+    if (_dupenv_s(&value, &size, "GLB_CPU_TIER") != 0 || !value) {
+        return {};
+    }
+    std::string result{value};
+    std::free(value);
+    return result;
+#else
+    const char *value{std::getenv("GLB_CPU_TIER")};
+    return value ? std::string{value} : std::string{};
+#endif
+}
+
+CpuTier pickTier() {
+    const CpuTier detected{detectedTier()};
+    const std::string requested{tierOverride()};
+    constexpr const char *names[]{"scalar", "sse2", "ssse3", "avx2", "avx512"};
+    for (int tier{0}; tier < static_cast<int>(CpuTier::COUNT); ++tier) {
+        if (requested == names[tier]) {
+            return std::min(detected, static_cast<CpuTier>(tier));
+        }
+    }
+    return detected;
+}
+
+} // namespace
+
+CpuTier detectedTier() {
+    static const CpuTier tier{detect()};
+    return tier;
+}
+
+CpuTier cpuTier() {
+    // Function-local so that kernels picked during static initialization of other files see it.
+    static const CpuTier tier{pickTier()};
+    return tier;
+}
+
+} // namespace glb
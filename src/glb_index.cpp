@@ -0,0 +1,283 @@
+#include "glb_index.hpp"
+#include "glb_kernels.hpp"
+#include <algorithm>
+#include <bit>
+#include <boost/multiprecision/cpp_int/import_export.hpp>
+#include <cstring>
+#include <new>
+
+namespace glb {
+
+namespace {
+
+ImageIndex::Limb *allocateLimbs() {
+    void *ptr{::operator new[](
+        ImageIndex::limbCount * sizeof(ImageIndex::Limb), std::align_val_t{ImageIndex::limbAlignment}
+    )};
+    std::memset(ptr, 0, ImageIndex::limbCount * sizeof(ImageIndex::Limb));
+    return static_cast<ImageIndex::Limb *>(ptr);
+}
+
+/*
+    cpp_int keeps its magnitude as little-endian limbs, which on a little-endian machine is just
+    a little-endian byte string. Reversing it gives the big-endian bytes directly, whatever the
+    limb width of the backend is. Returns the number of bytes written at the end of dst.
+*/
+std::size_t exportMagnitude(const mp::cpp_int &value, std::uint8_t *dst) {
+    const auto &backend{value.backend()};
+    const std::uint8_t *src{reinterpret_cast<const std::uint8_t *>(backend.limbs())};
+    const std::size_t n{std::min<std::size_t>(backend.size() * sizeof(mp::limb_type), ImageIndex::byteCount)};
+    reverseBytes(dst + (ImageIndex::byteCount - n), src, n);
+    return n;
+}
+
+bool exceedsWidth(const mp::cpp_int &value) { return value > 0 && mp::msb(value) >= maxB2; }
+
+} // namespace
+
+void ImageIndex::AlignedDelete::operator()(Limb *ptr) const {
+    ::operator delete[](ptr, std::align_val_t{limbAlignment});
+}
+
+ImageIndex::ImageIndex() : data(allocateLimbs()) {}
+
+ImageIndex::ImageIndex(const ImageIndex &other) : data(allocateLimbs()), used(other.used) {
+    std::memcpy(tail(used), other.tail(used), used * sizeof(Limb));
+}
+
+ImageIndex &ImageIndex::operator=(const ImageIndex &other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (!data) {
+        data.reset(allocateLimbs());
+    }
+    // Limbs past both upper bounds are already zero on each side.
+    const std::size_t n{std::max(used, other.used)};
+    std::memcpy(tail(n), other.tail(n), n * sizeof(Limb));
+    used = other.used;
+    markTail(n);
+    return *this;
+}
+
+ImageIndex &ImageIndex::operator=(ImageIndex &&other) noexcept {
+    data = std::move(other.data);
+    used = std::exchange(other.used, 0);
+    // Whatever was drawn from the old value knows nothing about the new one.
+    touch(ByteRange{0, byteCount});
+    return *this;
+}
+
+void ImageIndex::markChanged(std::size_t fromEnd, Limb before, Limb after) {
+    const Limb diff{before ^ after};
+    if (diff == 0) {
+        return;
+    }
+    // Native significance maps to memory order: leading zero bytes of the difference come first.
+    const std::size_t first{byteCount - (fromEnd + 1) * sizeof(Limb)};
+    touch(ByteRange{
+        first + static_cast<std::size_t>(std::countl_zero(diff)) / CHAR_BIT,
+        first + sizeof(Limb) - static_cast<std::size_t>(std::countr_zero(diff)) / CHAR_BIT
+    });
+}
+
+void ImageIndex::setLimb(std::size_t i, Limb value) {
+    Limb &stored{data[limbCount - 1 - i]};
+    markChanged(i, bswap64(stored), value);
+    stored = bswap64(value);
+    if (value != 0) {
+        used = std::max(used, i + 1);
+        return;
+    }
+    while (used != 0 && *tail(used) == 0) {
+        --used;
+    }
+}
+
+void ImageIndex::addSaturate(const ImageIndex &rhs) {
+    Limb *dst{data.get() + limbCount - 1};
+    ByteRange changed{};
+    Limb carry{addLimbs(tail(rhs.used), rhs.tail(rhs.used), rhs.used, 0, changed)};
+    touchTail(rhs.used, changed);
+    std::size_t i{rhs.used};
+    // The carry stops at the first limb that does not overflow, which is almost always the next one.
+    for (; carry && i < limbCount; ++i) {
+        const Limb out{bswap64(*(dst - i)) + 1};
+        carry = out == 0;
+        *(dst - i) = bswap64(out);
+        markChanged(i, out - 1, out);
+    }
+    if (carry) {
+        std::fill_n(data.get(), limbCount, ~Limb{0});
+        used = limbCount;
+        markTail(limbCount);
+        return;
+    }
+    used = std::max(used, i);
+}
+
+void ImageIndex::subSaturate(const ImageIndex &rhs) {
+    Limb *dst{data.get() + limbCount - 1};
+    used = std::max(used, rhs.used);
+    ByteRange changed{};
+    Limb borrow{subLimbs(tail(rhs.used), rhs.tail(rhs.used), rhs.used, 0, changed)};
+    touchTail(rhs.used, changed);
+    std::size_t i{rhs.used};
+    for (; borrow && i < limbCount; ++i) {
+        const Limb a{bswap64(*(dst - i))};
+        borrow = a == 0;
+        *(dst - i) = bswap64(a - 1);
+        markChanged(i, a, a - 1);
+    }
+    if (borrow) {
+        // The borrow ran through every limb, not only the ones below used.
+        used = limbCount;
+        clear();
+        return;
+    }
+    while (used != 0 && *tail(used) == 0) {
+        --used;
+    }
+}
+
+void ImageIndex::addScaled(const ImageIndex &rhs, Limb k) {
+    if (k == 0) {
+        return;
+    }
+    Limb *dst{data.get() + limbCount - 1};
+    ByteRange changed{};
+    Limb carry{addMulLimbs(tail(rhs.used), rhs.tail(rhs.used), rhs.used, k, changed)};
+    touchTail(rhs.used, changed);
+    std::size_t i{rhs.used};
+    // Past rhs a whole limb is added once, after that it is down to a single carry bit.
+    for (; carry && i < limbCount; ++i) {
+        const Limb a{bswap64(*(dst - i))};
+        const Limb out{a + carry};
+        carry = out < a;
+        *(dst - i) = bswap64(out);
+        markChanged(i, a, out);
+    }
+    if (carry) {
+        std::fill_n(data.get(), limbCount, ~Limb{0});
+        used = limbCount;
+        markTail(limbCount);
+        return;
+    }
+    used = std::max(used, i);
+}
+
+void ImageIndex::subScaled(const ImageIndex &rhs, Limb k) {
+    if (k == 0) {
+        return;
+    }
+    Limb *dst{data.get() + limbCount - 1};
+    used = std::max(used, rhs.used);
+    ByteRange changed{};
+    Limb borrow{subMulLimbs(tail(rhs.used), rhs.tail(rhs.used), rhs.used, k, changed)};
+    touchTail(rhs.used, changed);
+    std::size_t i{rhs.used};
+    for (; borrow && i < limbCount; ++i) {
+        const Limb a{bswap64(*(dst - i))};
+        const Limb out{a - borrow};
+        borrow = a < borrow;
+        *(dst - i) = bswap64(out);
+        markChanged(i, a, out);
+    }
+    if (borrow) {
+        used = limbCount;
+        clear();
+        return;
+    }
+    while (used != 0 && *tail(used) == 0) {
+        --used;
+    }
+}
+
+void ImageIndex::assign(const mp::cpp_int &value) {
+    clear();
+    if (value <= 0) {
+        return;
+    }
+    if (exceedsWidth(value)) {
+        std::fill_n(data.get(), limbCount, ~Limb{0});
+        used = limbCount;
+        markTail(limbCount);
+        return;
+    }
+    const std::size_t valueBytes{exportMagnitude(value, bytes())};
+    used = (valueBytes + sizeof(Limb) - 1) / sizeof(Limb);
+    markTail(used);
+}
+
+void ImageIndex::assign(const BigNat &value) {
+    clear();
+    if (value.limbs.size() > limbCount) {
+        std::fill_n(data.get(), limbCount, ~Limb{0});
+        used = limbCount;
+        markTail(limbCount);
+        return;
+    }
+    used = value.limbs.size();
+    markTail(used);
+    reverseBytes(
+        reinterpret_cast<std::uint8_t *>(tail(used)), reinterpret_cast<const std::uint8_t *>(value.limbs.data()),
+        used * sizeof(Limb)
+    );
+}
+
+void ImageIndex::assignBytes(const std::uint8_t *src, std::size_t size) {
+    // Read as a big-endian number, the first byte is the most significant one.
+    size = std::min(size, byteCount);
+    std::memcpy(bytes(), src, size);
+    std::memset(bytes() + size, 0, byteCount - size);
+    used = limbCount;
+    markTail(limbCount);
+    while (used != 0 && *tail(used) == 0) {
+        --used;
+    }
+}
+
+void ImageIndex::assignRandom(std::uint64_t key) {
+    philoxFill(bytes(), byteCount, key);
+    used = limbCount;
+    markTail(limbCount);
+    while (used != 0 && *tail(used) == 0) {
+        --used;
+    }
+}
+
+void ImageIndex::clear() {
+    std::memset(tail(used), 0, used * sizeof(Limb));
+    markTail(used);
+    used = 0;
+}
+
+mp::cpp_int ImageIndex::toCppInt() const {
+    mp::cpp_int value{};
+    if (used == 0) {
+        return value;
+    }
+    const std::uint8_t *first{reinterpret_cast<const std::uint8_t *>(tail(used))};
+    mp::import_bits(value, first, first + used * sizeof(Limb), CHAR_BIT);
+    return value;
+}
+
+bool ImageIndex::operator==(const ImageIndex &rhs) const {
+    const std::size_t n{std::max(used, rhs.used)};
+    return std::memcmp(tail(n), rhs.tail(n), n * sizeof(Limb)) == 0;
+}
+
+void exportFixed(const mp::cpp_int &value, std::uint8_t *dst) {
+    if (value <= 0) {
+        std::memset(dst, 0, ImageIndex::byteCount);
+        return;
+    }
+    if (exceedsWidth(value)) {
+        std::memset(dst, 0xFF, ImageIndex::byteCount);
+        return;
+    }
+    const std::size_t n{exportMagnitude(value, dst)};
+    std::memset(dst, 0, ImageIndex::byteCount - n);
+}
+
+} // namespace glb
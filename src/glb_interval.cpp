@@ -0,0 +1,148 @@
+#include "glb_interval.hpp"
+#include "glb_bignum.hpp"
+#include <algorithm>
+#include <bit>
+#include <optional>
+#include <utility>
+
+namespace glb {
+
+namespace {
+
+/*
+    One multiplication of the plan below. An NTT multiplication costs roughly in proportion to
+    the size of its output, which in turn is proportional to the exponent it produces.
+*/
+struct Step {
+    int bit{};
+    bool cached{};
+    bool multiply{};
+};
+
+/*
+    Plans 10^exponent as cachedBase * 10^(sum of 2^k): the binary powers are walked upwards,
+    loading the ones the cache has and squaring the previous one otherwise, and multiplied
+    into the result smallest first. Returns the steps together with their total weight.
+*/
+std::vector<Step> plan(PowerCache &cache, std::uint64_t remainder, double &weight) {
+    std::vector<Step> steps{};
+    std::uint64_t accumulated{0};
+    weight = 0.0;
+    for (int bit{0}; bit < static_cast<int>(std::bit_width(remainder)); ++bit) {
+        const std::uint64_t power{std::uint64_t{1} << bit};
+        const bool cached{bit == 0 || cache.floorExponent(power) == power};
+        const bool multiply{((remainder >> bit) & 1) != 0};
+        if (!cached) {
+            weight += static_cast<double>(power);
+        }
+        if (multiply) {
+            accumulated += power;
+            weight += static_cast<double>(accumulated);
+        }
+        steps.push_back(Step{bit, cached, multiply});
+    }
+    return steps;
+}
+
+} // namespace
+
+void IntervalEngine::compute(std::stop_token stop, std::shared_ptr<IntervalJob> job, PowerCache *cache) {
+    const std::uint64_t exponent{job->exponent};
+    if (std::optional<BigNat> hit{cache->find(exponent)}) {
+        job->result.assign(*hit);
+        job->succeeded = true;
+        job->finished.store(true, std::memory_order_release);
+        return;
+    }
+    // A record failing its checksum is dropped by find(), in which case we simply start from 1.
+    std::uint64_t base{cache->floorExponent(exponent).value_or(0)};
+    std::optional<BigNat> baseValue{base != 0 ? cache->find(base) : std::nullopt};
+    if (!baseValue) {
+        base = 0;
+    }
+    double weight{};
+    const std::vector<Step> steps{plan(*cache, exponent - base, weight)};
+    if (baseValue) {
+        weight += static_cast<double>(exponent);
+    }
+    double done{0.0};
+    const auto advance{[&](std::uint64_t amount) {
+        done += static_cast<double>(amount);
+        job->progress.store(static_cast<float>(done / weight), std::memory_order_relaxed);
+    }};
+
+    BigNat value{{1}};
+    BigNat power{{10}};
+    std::uint64_t accumulated{0};
+    // Cancellation is checked between multiplications, the largest of which dominates anyway.
+    for (const Step &step : steps) {
+        if (stop.stop_requested()) {
+            break;
+        }
+        const std::uint64_t powerExponent{std::uint64_t{1} << step.bit};
+        if (step.bit != 0) {
+            std::optional<BigNat> loaded{step.cached ? cache->find(powerExponent) : std::nullopt};
+            if (loaded) {
+                power = std::move(*loaded);
+            } else {
+                power = square(power);
+                cache->store(powerExponent, power);
+                advance(powerExponent);
+            }
+        }
+        if (step.multiply) {
+            accumulated += powerExponent;
+            value = accumulated == powerExponent ? power : mul(value, power);
+            advance(accumulated);
+        }
+    }
+    if (baseValue && !stop.stop_requested()) {
+        value = mul(value, *baseValue);
+    }
+    if (!stop.stop_requested()) {
+        // Kept only if the exponent is a checkpoint itself.
+        cache->store(exponent, value);
+        job->result.assign(value);
+        job->succeeded = true;
+    }
+    job->finished.store(true, std::memory_order_release);
+}
+
+void IntervalEngine::openCache(const std::filesystem::path &path) { cache.open(path); }
+
+void IntervalEngine::request(std::uint64_t exponent) {
+    if (current.job) {
+        current.thread.request_stop();
+        retired.push_back(std::move(current));
+    }
+    current.job = std::make_shared<IntervalJob>();
+    current.job->exponent = exponent;
+    current.thread = std::jthread{compute, current.job, &cache};
+}
+
+bool IntervalEngine::poll(ImageIndex &interval) {
+    // Finished threads join immediately, the rest are left to notice their stop request.
+    std::erase_if(retired, [](const Worker &worker) {
+        return worker.job->finished.load(std::memory_order_acquire);
+    });
+    if (!current.job || !current.job->finished.load(std::memory_order_acquire)) {
+        return false;
+    }
+    const bool succeeded{current.job->succeeded};
+    if (succeeded) {
+        std::swap(interval, current.job->result);
+    }
+    current.thread.join();
+    current = Worker{};
+    return succeeded;
+}
+
+bool IntervalEngine::busy() const { return current.job != nullptr; }
+
+float IntervalEngine::progress() const {
+    return current.job ? current.job->progress.load(std::memory_order_relaxed) : 1.0f;
+}
+
+std::uint64_t IntervalEngine::target() const { return current.job ? current.job->exponent : 0; }
+
+} // namespace glb
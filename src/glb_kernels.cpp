@@ -0,0 +1,1466 @@
+#include "glb_kernels.hpp"
+#include "glb_cpu.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLB_SSE2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC emits any intrinsic it is given, GCC and Clang only inside functions targeting that ISA.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define GLB_TARGET(isa)
+#else
+#define GLB_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace glb {
+
+namespace {
+
+constexpr const std::size_t channels{3};
+// Below this many bytes per thread, handing work to another thread costs more than it saves.
+constexpr const std::size_t minDecodeChunk{std::size_t{256} << 10};
+// Philox does far more work per byte than a decode pass, so much smaller runs are worth a thread.
+constexpr const std::size_t minRandomChunk{std::size_t{64} << 10};
+constexpr const std::size_t maxWorkers{8};
+
+constexpr const std::uint32_t philoxM0{0xD2511F53};
+constexpr const std::uint32_t philoxM1{0xCD9E8D57};
+constexpr const std::uint32_t philoxW0{0x9E3779B9};
+constexpr const std::uint32_t philoxW1{0xBB67AE85};
+constexpr const unsigned philoxRounds{10};
+constexpr const std::size_t philoxBlockBytes{16};
+
+using Deinterleave = void (*)(std::uint8_t *, std::uint8_t *, std::uint8_t *, const std::uint8_t *, std::size_t);
+using ColorConvert = void (*)(std::uint8_t *, std::uint8_t *, std::uint8_t *, std::size_t);
+using ReverseBytes = void (*)(std::uint8_t *, const std::uint8_t *, std::size_t);
+using GrayEncode = void (*)(std::uint8_t *, const std::uint8_t *, std::size_t, std::uint8_t);
+using GrayDecode = bool (*)(std::uint8_t *, const std::uint8_t *, std::size_t, bool);
+using TransposePlanes = void (*)(std::uint8_t *, const std::uint8_t *, std::size_t, std::size_t);
+using ExtractRow = void (*)(std::uint8_t *, const std::uint8_t *, unsigned, std::size_t);
+using GatherPixels = void (*)(std::uint8_t *, const std::uint8_t *, std::size_t, const std::uint32_t *, std::size_t);
+using PhiloxBlocks = void (*)(std::uint8_t *, std::uint64_t, std::size_t, std::uint64_t);
+
+/*
+    Which bytes of a run of limbs changed. Limbs are stored most significant first and have to be
+    noted from the last one towards the first, so the first note is the end of the range and the
+    latest note its beginning. Diffs are of the raw stored words, whose lowest byte on a
+    little-endian host is the first one in memory.
+*/
+struct ChangeTracker {
+    std::size_t first{};
+    std::size_t last{};
+    std::uint64_t firstDiff{};
+    std::uint64_t lastDiff{};
+    void note(std::size_t i, std::uint64_t diff) {
+        if (diff == 0) {
+            return;
+        }
+        if (lastDiff == 0) {
+            last = i;
+            lastDiff = diff;
+        }
+        first = i;
+        firstDiff = diff;
+    }
+    // Lanes base + k for the bits k set in changed, diffs indexed by k.
+    void noteLanes(std::size_t base, const std::uint64_t *diffs, unsigned changed) {
+        if (changed == 0) {
+            return;
+        }
+        const std::size_t high{static_cast<std::size_t>(std::bit_width(changed)) - 1};
+        const std::size_t low{static_cast<std::size_t>(std::countr_zero(changed))};
+        note(base + high, diffs[high]);
+        note(base + low, diffs[low]);
+    }
+    ByteRange range() const {
+        if (lastDiff == 0) {
+            return ByteRange{};
+        }
+        return ByteRange{
+            first * sizeof(std::uint64_t) + static_cast<std::size_t>(std::countr_zero(firstDiff)) / CHAR_BIT,
+            (last + 1) * sizeof(std::uint64_t) - static_cast<std::size_t>(std::countl_zero(lastDiff)) / CHAR_BIT
+        };
+    }
+};
+
+using CarryKernel =
+    std::uint64_t (*)(std::uint64_t *, const std::uint64_t *, std::size_t, std::uint64_t, ChangeTracker &);
+
+void reverseBytesScalar(std::uint8_t *dst, const std::uint8_t *src, std::size_t n) {
+    std::reverse_copy(src, src + n, dst);
+}
+
+/*
+    before stands in for src[-1], the byte whose lowest bit shifts into src[0]. All encoders run
+    from the back, so every byte is read before the one after it is overwritten and dst may be src.
+*/
+void grayEncodeScalar(std::uint8_t *dst, const std::uint8_t *src, std::size_t n, std::uint8_t before) {
+    for (std::size_t k{n}; k-- > 0;) {
+        const std::uint8_t prev{k != 0 ? src[k - 1] : before};
+        dst[k] = static_cast<std::uint8_t>(src[k] ^ (src[k] >> 1) ^ ((prev & 1) << 7));
+    }
+}
+
+// Each bit XORed with every bit above it, the inverse of x ^ x >> 1.
+inline std::uint64_t prefixXor(std::uint64_t x) {
+    x ^= x >> 1;
+    x ^= x >> 2;
+    x ^= x >> 4;
+    x ^= x >> 8;
+    x ^= x >> 16;
+    return x ^ (x >> 32);
+}
+
+/*
+    Decoding runs front to back: every bit is the XOR of all bits before it, so a word only needs
+    the parity of everything above it, which is the lowest bit of the previous decoded word.
+    parity is that bit for src[0] and the one for src[n] is returned. dst may be src.
+*/
+bool grayDecodeScalar(std::uint8_t *dst, const std::uint8_t *src, std::size_t n, bool parity) {
+    std::size_t k{0};
+    for (; k + sizeof(std::uint64_t) <= n; k += sizeof(std::uint64_t)) {
+        std::uint64_t word{};
+        std::memcpy(&word, src + k, sizeof(word));
+        const std::uint64_t bits{prefixXor(bswap64(word)) ^ (std::uint64_t{0} - parity)};
+        parity = bits & 1;
+        word = bswap64(bits);
+        std::memcpy(dst + k, &word, sizeof(word));
+    }
+    for (; k < n; ++k) {
+        const std::uint8_t bits{static_cast<std::uint8_t>(prefixXor(src[k]) ^ (parity ? 0xFF : 0))};
+        parity = bits & 1;
+        dst[k] = bits;
+    }
+    return parity;
+}
+
+// Parity of all bits of src, where a decoder starting at src + n picks up.
+bool xorParity(const std::uint8_t *src, std::size_t n) {
+    std::uint64_t folded{0};
+    std::size_t k{0};
+    for (; k + sizeof(std::uint64_t) <= n; k += sizeof(std::uint64_t)) {
+        std::uint64_t word{};
+        std::memcpy(&word, src + k, sizeof(word));
+        folded ^= word;
+    }
+    for (; k < n; ++k) {
+        folded ^= src[k];
+    }
+    return std::popcount(folded) & 1;
+}
+
+/*
+    The 8x8 bit matrix held in x with byte r as row r and bit 7 - c as column c, transposed: bit
+    (r, c) of the result is bit (c, r) of x. In the bit numbering of x this is a flip about the
+    anti-diagonal, done as three rounds of swapping blocks of 4, 2 and 1 bits.
+*/
+inline std::uint64_t transposeBits(std::uint64_t x) {
+    std::uint64_t t{x ^ (x << 36)};
+    x ^= 0xF0F0'F0F0'0F0F'0F0F & (t ^ (x >> 36));
+    t = 0xCCCC'0000'CCCC'0000 & (x ^ (x << 18));
+    x ^= t ^ (t >> 18);
+    t = 0xAA00'AA00'AA00'AA00 & (x ^ (x << 9));
+    return x ^ t ^ (t >> 9);
+}
+
+void transposePlanesScalar(std::uint8_t *dst, const std::uint8_t *src, std::size_t stride, std::size_t groups) {
+    for (std::size_t g{0}; g < groups; ++g) {
+        std::uint64_t rows{0};
+        for (std::size_t s{0}; s < CHAR_BIT; ++s) {
+            rows |= std::uint64_t{src[s * stride + g]} << (CHAR_BIT * s);
+        }
+        const std::uint64_t columns{transposeBits(rows)};
+        std::memcpy(dst + CHAR_BIT * g, &columns, sizeof(columns));
+    }
+}
+
+// The multiply moves bit 8c of the masked word to bit 63 - c and nothing else into the top byte.
+void extractRowScalar(std::uint8_t *dst, const std::uint8_t *src, unsigned row, std::size_t count) {
+    for (std::size_t m{0}; m < count; ++m) {
+        std::uint64_t word{};
+        std::memcpy(&word, src + CHAR_BIT * m, sizeof(word));
+        const std::uint64_t bits{(word >> (7 - row)) & 0x0101'0101'0101'0101};
+        dst[m] = static_cast<std::uint8_t>((bits * 0x8040'2010'0804'0201) >> 56);
+    }
+}
+
+/*
+    Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"), blocks
+    [block, block + blocks) of the stream for key. Every block is ten multiply-and-xor rounds over
+    its own counter, so any part of the stream can be made without the rest.
+*/
+void philoxScalar(std::uint8_t *dst, std::uint64_t block, std::size_t blocks, std::uint64_t key) {
+    for (std::size_t i{0}; i < blocks; ++i, ++block) {
+        std::uint32_t c0{static_cast<std::uint32_t>(block)}, c1{static_cast<std::uint32_t>(block >> 32)};
+        std::uint32_t c2{0}, c3{0};
+        std::uint32_t k0{static_cast<std::uint32_t>(key)}, k1{static_cast<std::uint32_t>(key >> 32)};
+        for (unsigned r{0}; r < philoxRounds; ++r) {
+            const std::uint64_t p0{std::uint64_t{philoxM0} * c0};
+            const std::uint64_t p1{std::uint64_t{philoxM1} * c2};
+            c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<std::uint32_t>(p1);
+            c3 = static_cast<std::uint32_t>(p0);
+            k0 += philoxW0;
+            k1 += philoxW1;
+        }
+        const std::uint32_t words[]{c0, c1, c2, c3};
+        std::memcpy(dst + i * philoxBlockBytes, words, philoxBlockBytes);
+    }
+}
+
+void gatherPixelsScalar(
+    std::uint8_t *dst, const std::uint8_t *src, std::size_t, const std::uint32_t *pixels, std::size_t count
+) {
+    for (std::size_t k{0}; k < count; ++k) {
+        std::memcpy(dst + channels * k, src + channels * pixels[k], channels);
+    }
+}
+
+// The schoolbook carry chain, one limb at a time from the least significant end.
+template <bool subtract>
+std::uint64_t carryScalar(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t carry, ChangeTracker &changes
+) {
+    for (std::size_t i{n}; i-- > 0;) {
+        const std::uint64_t a{bswap64(dst[i])}, b{bswap64(src[i])};
+        std::uint64_t out{};
+        if constexpr (subtract) {
+            const std::uint64_t diff{a - b};
+            out = diff - carry;
+            carry = (a < b) | (diff < carry);
+        } else {
+            const std::uint64_t sum{a + b};
+            out = sum + carry;
+            carry = (sum < a) | (out < sum);
+        }
+        const std::uint64_t stored{bswap64(out)};
+        changes.note(i, dst[i] ^ stored);
+        dst[i] = stored;
+    }
+    return carry;
+}
+
+/*
+    dst += src * k or dst -= src * k, one 64x64-bit product per limb with a whole limb carried
+    between them. There is no SIMD version: none of the tiers multiplies 64-bit lanes into 128 bits.
+*/
+template <bool subtract>
+std::uint64_t mulCarryScalar(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t k, ChangeTracker &changes
+) {
+    std::uint64_t carry{0};
+    for (std::size_t i{n}; i-- > 0;) {
+        std::uint64_t hi{};
+        std::uint64_t lo{mulWide(bswap64(src[i]), k, hi)};
+        lo += carry;
+        hi += lo < carry;
+        const std::uint64_t a{bswap64(dst[i])};
+        std::uint64_t out{};
+        if constexpr (subtract) {
+            out = a - lo;
+            hi += a < lo;
+        } else {
+            out = a + lo;
+            hi += out < a;
+        }
+        carry = hi;
+        const std::uint64_t stored{bswap64(out)};
+        changes.note(i, dst[i] ^ stored);
+        dst[i] = stored;
+    }
+    return carry;
+}
+
+/*
+    Output k of channel j comes from src[3k + j], or when reversed from src[3(count - 1 - k) + 2 - j]:
+    reading the triples backwards mirrors the pixels and swaps the first and last channel.
+*/
+template <bool reversed>
+void deinterleaveScalar(
+    std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, const std::uint8_t *src, std::size_t count
+) {
+    for (std::size_t k = 0; k < count; ++k) {
+        const std::uint8_t *triple{src + channels * (reversed ? count - 1 - k : k)};
+        c0[k] = triple[reversed ? 2 : 0];
+        c1[k] = triple[1];
+        c2[k] = triple[reversed ? 0 : 2];
+    }
+}
+
+/*
+    HSVtoRGBModified from CImg.h. Its four divisions and the fmod each depend on a single channel
+    byte, so they are done once per byte value here, with the same float operations, and what is
+    left per pixel is c = v s, x = c f(h), m = v - c and the rounding. CImg calls the unqualified
+    fmod, which is the double one under libstdc++ and the float one under MSVC; both give the same
+    bytes for every input, so this sticks to float throughout. fmod(h', 2) is written as
+    h' - 2 trunc(h' / 2), which is exact for h' in [0, 6] and can be evaluated at compile time.
+    Checked against CImg over all 2^24 inputs by tests/color_exhaustive.cpp.
+*/
+struct HsvTables {
+    std::array<float, 256> unit{}; // i / 255, for both saturation and value.
+    std::array<float, 256> factor{}; // 1 - |fmod(h', 2) - 1| with h' = (h * 360 / 255) / 60.
+    std::array<std::int32_t, 256> sector{}; // floor(h'), 6 only for h = 255.
+    std::array<std::uint8_t, 6> sectorStart{}; // Smallest h of sectors 1 to 5, sector rising with h.
+};
+
+constexpr HsvTables makeHsvTables() {
+    HsvTables tables{};
+    for (int i = 0; i < 256; ++i) {
+        const float hue{static_cast<float>(i) * 360.0f / 255.0f};
+        const float hPrime{hue / 60.0f};
+        const float wrapped{hPrime - 2.0f * static_cast<float>(static_cast<int>(hPrime * 0.5f))};
+        const float distance{wrapped - 1.0f};
+        tables.unit[i] = static_cast<float>(i) / 255.0f;
+        tables.factor[i] = 1.0f - (distance < 0.0f ? -distance : distance);
+        tables.sector[i] = static_cast<std::int32_t>(hPrime);
+    }
+    for (int i = 255; i > 0; --i) {
+        if (tables.sector[i] != tables.sector[i - 1] && tables.sector[i] <= 5) {
+            tables.sectorStart[tables.sector[i]] = static_cast<std::uint8_t>(i);
+        }
+    }
+    return tables;
+}
+
+constexpr const HsvTables hsvTables{makeHsvTables()};
+
+inline void hsvPixel(std::uint8_t &r, std::uint8_t &g, std::uint8_t &b) {
+    const HsvTables &t{hsvTables};
+    const float value{t.unit[b]};
+    const float c{value * t.unit[g]};
+    const float x{c * t.factor[r]};
+    const float m{value - c};
+    float rTemp{}, gTemp{}, bTemp{};
+    switch (t.sector[r]) {
+    case 0: rTemp = c, gTemp = x, bTemp = 0; break;
+    case 1: rTemp = x, gTemp = c, bTemp = 0; break;
+    case 2: rTemp = 0, gTemp = c, bTemp = x; break;
+    case 3: rTemp = 0, gTemp = x, bTemp = c; break;
+    case 4: rTemp = x, gTemp = 0, bTemp = c; break;
+    default: rTemp = c, gTemp = 0, bTemp = x; break;
+    }
+    r = static_cast<std::uint8_t>(std::round((rTemp + m) * 255.0f));
+    g = static_cast<std::uint8_t>(std::round((gTemp + m) * 255.0f));
+    b = static_cast<std::uint8_t>(std::round((bTemp + m) * 255.0f));
+}
+
+void hsvToRgbScalar(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    for (std::size_t k = 0; k < count; ++k) {
+        hsvPixel(c0[k], c1[k], c2[k]);
+    }
+}
+
+/*
+    CImg's YCbCrtoRGB computes R = (298(Y - 16) + 409(Cr - 128) + 128) / 256 and so on in float,
+    clamps to [0, 255] and truncates. Every intermediate is an integer below 2^24 and the division
+    is by a power of two, so all of it is exact: the result is the integer sum shifted right by 8
+    and saturated. The sum splits into one contribution per input channel.
+*/
+struct YCbCrTables {
+    std::array<std::int32_t, 256> luma{}; // Shared by all three outputs, rounding term included.
+    std::array<std::int32_t, 256> crToR{};
+    std::array<std::int32_t, 256> cbToG{};
+    std::array<std::int32_t, 256> crToG{};
+    std::array<std::int32_t, 256> cbToB{};
+};
+
+constexpr YCbCrTables makeYCbCrTables() {
+    YCbCrTables tables{};
+    for (std::int32_t i = 0; i < 256; ++i) {
+        tables.luma[i] = 298 * (i - 16) + 128;
+        tables.crToR[i] = 409 * (i - 128);
+        tables.cbToG[i] = -100 * (i - 128);
+        tables.crToG[i] = -208 * (i - 128);
+        tables.cbToB[i] = 516 * (i - 128);
+    }
+    return tables;
+}
+
+constexpr const YCbCrTables ycbcrTables{makeYCbCrTables()};
+
+inline std::uint8_t saturate(std::int32_t sum) {
+    return static_cast<std::uint8_t>(std::clamp(sum >> 8, std::int32_t{0}, std::int32_t{255}));
+}
+
+void ycbcrToRgbScalar(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    const YCbCrTables &t{ycbcrTables};
+    for (std::size_t k = 0; k < count; ++k) {
+        const std::int32_t luma{t.luma[c0[k]]};
+        const std::uint8_t cb{c1[k]}, cr{c2[k]};
+        c0[k] = saturate(luma + t.crToR[cr]);
+        c1[k] = saturate(luma + t.cbToG[cb] + t.crToG[cr]);
+        c2[k] = saturate(luma + t.cbToB[cb]);
+    }
+}
+
+#ifdef GLB_SSE2
+// Full 16-byte reversal using only baseline SSE2: dwords, then words within dwords, then bytes within words.
+inline __m128i reverse16(__m128i v) {
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+void reverseBytesSse2(std::uint8_t *dst, const std::uint8_t *src, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 64 <= n; i += 64) {
+        const std::uint8_t *in{src + n - i - 64};
+        const __m128i a{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 48))};
+        const __m128i b{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 32))};
+        const __m128i c{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16))};
+        const __m128i d{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in))};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), reverse16(a));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 16), reverse16(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 32), reverse16(c));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 48), reverse16(d));
+    }
+    reverseBytesScalar(dst + i, src, n - i);
+}
+
+// x86 has no byte shifts, so shift words and mask off the bit that crossed into the neighbouring byte.
+void grayEncodeSse2(std::uint8_t *dst, const std::uint8_t *src, std::size_t n, std::uint8_t before) {
+    const __m128i low7{_mm_set1_epi8(0x7F)};
+    const __m128i high1{_mm_set1_epi8(static_cast<char>(0x80))};
+    std::size_t k{n};
+    for (; k > 16; k -= 16) {
+        const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k - 16))};
+        const __m128i prev{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + k - 17))};
+        const __m128i shifted{_mm_and_si128(_mm_srli_epi16(v, 1), low7)};
+        const __m128i carried{_mm_and_si128(_mm_slli_epi16(prev, 7), high1)};
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(dst + k - 16), _mm_xor_si128(_mm_xor_si128(v, shifted), carried)
+        );
+    }
+    grayEncodeScalar(dst, src, k, before);
+}
+
+/*
+    pshufb masks splitting 16 triples held in three registers into 16 bytes per channel:
+    masks[j][v] picks the bytes of channel j that live in register v, zeroing the rest.
+*/
+struct ShuffleMasks {
+    alignas(16) std::array<std::array<std::array<std::int8_t, 16>, channels>, channels> bytes{};
+};
+
+constexpr ShuffleMasks makeMasks(bool reversed) {
+    ShuffleMasks masks{};
+    for (std::size_t j = 0; j < channels; ++j) {
+        for (std::size_t k = 0; k < 16; ++k) {
+            const std::size_t s{reversed ? channels * (15 - k) + 2 - j : channels * k + j};
+            for (std::size_t v = 0; v < channels; ++v) {
+                masks.bytes[j][v][k] = static_cast<std::int8_t>(s / 16 == v ? s % 16 : 0x80);
+            }
+        }
+    }
+    return masks;
+}
+
+constexpr const ShuffleMasks forwardMasks{makeMasks(false)};
+constexpr const ShuffleMasks reversedMasks{makeMasks(true)};
+
+template <bool reversed>
+GLB_TARGET("ssse3")
+void deinterleaveSsse3(
+    std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, const std::uint8_t *src, std::size_t count
+) {
+    const ShuffleMasks &masks{reversed ? reversedMasks : forwardMasks};
+    __m128i m[channels][channels];
+    for (std::size_t j = 0; j < channels; ++j) {
+        for (std::size_t v = 0; v < channels; ++v) {
+            m[j][v] = _mm_load_si128(reinterpret_cast<const __m128i *>(masks.bytes[j][v].data()));
+        }
+    }
+    std::uint8_t *out[channels]{c0, c1, c2};
+    std::size_t k{0};
+    for (; k + 16 <= count; k += 16) {
+        const std::uint8_t *in{src + channels * (reversed ? count - k - 16 : k)};
+        const __m128i a{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in))};
+        const __m128i b{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16))};
+        const __m128i c{_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 32))};
+        for (std::size_t j = 0; j < channels; ++j) {
+            const __m128i value{_mm_or_si128(
+                _mm_or_si128(_mm_shuffle_epi8(a, m[j][0]), _mm_shuffle_epi8(b, m[j][1])), _mm_shuffle_epi8(c, m[j][2])
+            )};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out[j] + k), value);
+        }
+    }
+    // The remaining outputs come from the first triples when reversed, the last ones otherwise.
+    deinterleaveScalar<reversed>(c0 + k, c1 + k, c2 + k, reversed ? src : src + channels * k, count - k);
+}
+
+GLB_TARGET("avx2")
+inline __m256i load2(const std::uint8_t *lo, const std::uint8_t *hi) {
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lo))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi)), 1
+    );
+}
+
+// Same shuffles on two groups of 16 triples at once, one per 128-bit lane.
+template <bool reversed>
+GLB_TARGET("avx2")
+void deinterleaveAvx2(
+    std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, const std::uint8_t *src, std::size_t count
+) {
+    const ShuffleMasks &masks{reversed ? reversedMasks : forwardMasks};
+    __m256i m[channels][channels];
+    for (std::size_t j = 0; j < channels; ++j) {
+        for (std::size_t v = 0; v < channels; ++v) {
+            m[j][v] = _mm256_broadcastsi128_si256(
+                _mm_load_si128(reinterpret_cast<const __m128i *>(masks.bytes[j][v].data()))
+            );
+        }
+    }
+    std::uint8_t *out[channels]{c0, c1, c2};
+    std::size_t k{0};
+    for (; k + 32 <= count; k += 32) {
+        const std::uint8_t *in{src + channels * (reversed ? count - k - 32 : k)};
+        // Reversed, the later group of triples produces the earlier outputs.
+        const std::uint8_t *lo{reversed ? in + 48 : in};
+        const std::uint8_t *hi{reversed ? in : in + 48};
+        const __m256i a{load2(lo, hi)};
+        const __m256i b{load2(lo + 16, hi + 16)};
+        const __m256i c{load2(lo + 32, hi + 32)};
+        for (std::size_t j = 0; j < channels; ++j) {
+            const __m256i value{_mm256_or_si256(
+                _mm256_or_si256(_mm256_shuffle_epi8(a, m[j][0]), _mm256_shuffle_epi8(b, m[j][1])),
+                _mm256_shuffle_epi8(c, m[j][2])
+            )};
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out[j] + k), value);
+        }
+    }
+    deinterleaveSsse3<reversed>(c0 + k, c1 + k, c2 + k, reversed ? src : src + channels * k, count - k);
+}
+
+/*
+    The same arithmetic four pixels at a time, on table entries fetched by the caller. Every step
+    is a single IEEE operation that SSE rounds exactly like the scalar code does, and std::round,
+    which rounds halves away from zero, becomes trunc(x) + (x - trunc(x) >= 0.5) since all values
+    are non-negative. Gives the three candidate outputs c + m, x + m and m, scaled and rounded.
+*/
+inline __m128i roundToInt(__m128 x) {
+    const __m128i whole{_mm_cvttps_epi32(x)};
+    const __m128 fraction{_mm_sub_ps(x, _mm_cvtepi32_ps(whole))};
+    return _mm_sub_epi32(whole, _mm_castps_si128(_mm_cmpge_ps(fraction, _mm_set1_ps(0.5f))));
+}
+
+inline void hsvQuad(
+    __m128 saturation, __m128 value, __m128 factor, __m128i &outC, __m128i &outX, __m128i &outZero
+) {
+    const __m128 c{_mm_mul_ps(value, saturation)};
+    const __m128 x{_mm_mul_ps(c, factor)};
+    const __m128 m{_mm_sub_ps(value, c)};
+    const __m128 scale{_mm_set1_ps(255.0f)};
+    outC = roundToInt(_mm_mul_ps(_mm_add_ps(c, m), scale));
+    outX = roundToInt(_mm_mul_ps(_mm_add_ps(x, m), scale));
+    outZero = roundToInt(_mm_mul_ps(m, scale));
+}
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/*
+    The switch of hsvPixel on sixteen packed pixels, sectors coming from comparing h against
+    where each one starts. Sector 6 only occurs for a hue of exactly 360 and takes the switch's
+    default, like sector 5, which is why nothing starts it.
+*/
+inline void hsvSelect(
+    __m128i h, __m128i outC, __m128i outX, __m128i outZero, __m128i &r, __m128i &g, __m128i &b
+) {
+    const HsvTables &t{hsvTables};
+    const auto from{[&](int sector) {
+        return _mm_cmpeq_epi8(_mm_max_epu8(h, _mm_set1_epi8(static_cast<char>(t.sectorStart[sector]))), h);
+    }};
+    const __m128i ge1{from(1)}, ge2{from(2)}, ge3{from(3)}, ge4{from(4)}, ge5{from(5)};
+    const __m128i rX{_mm_or_si128(_mm_andnot_si128(ge2, ge1), _mm_andnot_si128(ge5, ge4))};
+    r = select(_mm_andnot_si128(ge4, ge2), outZero, select(rX, outX, outC));
+    g = select(ge4, outZero, select(_mm_andnot_si128(ge3, ge1), outC, outX));
+    b = select(ge2, select(_mm_andnot_si128(ge5, ge3), outC, outX), outZero);
+}
+
+void hsvToRgbSse2(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    const HsvTables &t{hsvTables};
+    std::size_t k{0};
+    for (; k + 16 <= count; k += 16) {
+        // SSE2 has no gather, so the table entries are staged through the stack.
+        alignas(16) float saturation[16], value[16], factor[16];
+        for (std::size_t i = 0; i < 16; ++i) {
+            saturation[i] = t.unit[c1[k + i]];
+            value[i] = t.unit[c2[k + i]];
+            factor[i] = t.factor[c0[k + i]];
+        }
+        __m128i outC[4], outX[4], outZero[4];
+        for (std::size_t q = 0; q < 4; ++q) {
+            hsvQuad(
+                _mm_load_ps(saturation + 4 * q), _mm_load_ps(value + 4 * q), _mm_load_ps(factor + 4 * q), outC[q],
+                outX[q], outZero[q]
+            );
+        }
+        const auto pack{[](const __m128i *q) {
+            return _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3]));
+        }};
+        __m128i r, g, b;
+        hsvSelect(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + k)), pack(outC), pack(outX), pack(outZero), r, g, b
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c0 + k), r);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c1 + k), g);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c2 + k), b);
+    }
+    hsvToRgbScalar(c0 + k, c1 + k, c2 + k, count - k);
+}
+
+GLB_TARGET("avx2")
+inline __m256i roundToInt(__m256 x) {
+    const __m256i whole{_mm256_cvttps_epi32(x)};
+    const __m256 fraction{_mm256_sub_ps(x, _mm256_cvtepi32_ps(whole))};
+    return _mm256_sub_epi32(whole, _mm256_castps_si256(_mm256_cmp_ps(fraction, _mm256_set1_ps(0.5f), _CMP_GE_OQ)));
+}
+
+// hsvQuad on eight pixels, fetching the table entries with gathers.
+GLB_TARGET("avx2")
+inline void hsvOctet(__m256i h, __m256i s, __m256i v, __m256i &outC, __m256i &outX, __m256i &outZero) {
+    const HsvTables &t{hsvTables};
+    const __m256 value{_mm256_i32gather_ps(t.unit.data(), v, sizeof(float))};
+    const __m256 c{_mm256_mul_ps(value, _mm256_i32gather_ps(t.unit.data(), s, sizeof(float)))};
+    const __m256 x{_mm256_mul_ps(c, _mm256_i32gather_ps(t.factor.data(), h, sizeof(float)))};
+    const __m256 m{_mm256_sub_ps(value, c)};
+    const __m256 scale{_mm256_set1_ps(255.0f)};
+    outC = roundToInt(_mm256_mul_ps(_mm256_add_ps(c, m), scale));
+    outX = roundToInt(_mm256_mul_ps(_mm256_add_ps(x, m), scale));
+    outZero = roundToInt(_mm256_mul_ps(m, scale));
+}
+
+GLB_TARGET("avx2")
+void hsvToRgbAvx2(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    std::size_t k{0};
+    for (; k + 16 <= count; k += 16) {
+        const auto widen{[&](const std::uint8_t *row, int half) GLB_TARGET("avx2") {
+            return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + k + 8 * half)));
+        }};
+        __m256i outC[2], outX[2], outZero[2];
+        hsvOctet(widen(c0, 0), widen(c1, 0), widen(c2, 0), outC[0], outX[0], outZero[0]);
+        hsvOctet(widen(c0, 1), widen(c1, 1), widen(c2, 1), outC[1], outX[1], outZero[1]);
+        // The packs work per lane, the permute puts the four quarters back in order.
+        const auto pack{[](const __m256i *q) GLB_TARGET("avx2") {
+            const __m256i words{_mm256_permute4x64_epi64(_mm256_packs_epi32(q[0], q[1]), _MM_SHUFFLE(3, 1, 2, 0))};
+            return _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+        }};
+        __m128i r, g, b;
+        hsvSelect(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + k)), pack(outC), pack(outX), pack(outZero), r, g, b
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c0 + k), r);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c1 + k), g);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c2 + k), b);
+    }
+    hsvToRgbScalar(c0 + k, c1 + k, c2 + k, count - k);
+}
+
+/*
+    The table contributions are linear, so in registers they are cheaper to recompute than to
+    look up: pmaddwd takes two channels and their coefficients per 32-bit lane, and the packs
+    saturate exactly like the clamp. The rounding term rides along with Cr in the green sum.
+*/
+void ycbcrToRgbSse2(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    const __m128i zero{_mm_setzero_si128()};
+    const __m128i lumaBias{_mm_set1_epi16(16)}, chromaBias{_mm_set1_epi16(128)}, one{_mm_set1_epi16(1)};
+    const __m128i rCoeffs{_mm_setr_epi16(298, 409, 298, 409, 298, 409, 298, 409)};
+    const __m128i gCoeffs{_mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100)};
+    const __m128i gCrCoeffs{_mm_setr_epi16(-208, 128, -208, 128, -208, 128, -208, 128)};
+    const __m128i bCoeffs{_mm_setr_epi16(298, 516, 298, 516, 298, 516, 298, 516)};
+    const __m128i rounding{_mm_set1_epi32(128)};
+    std::size_t k{0};
+    for (; k + 16 <= count; k += 16) {
+        const __m128i y{_mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + k))};
+        const __m128i cb{_mm_loadu_si128(reinterpret_cast<const __m128i *>(c1 + k))};
+        const __m128i cr{_mm_loadu_si128(reinterpret_cast<const __m128i *>(c2 + k))};
+        __m128i words[3][2];
+        for (int half = 0; half < 2; ++half) {
+            const __m128i y16{_mm_sub_epi16(half ? _mm_unpackhi_epi8(y, zero) : _mm_unpacklo_epi8(y, zero), lumaBias)};
+            const __m128i cb16{
+                _mm_sub_epi16(half ? _mm_unpackhi_epi8(cb, zero) : _mm_unpacklo_epi8(cb, zero), chromaBias)
+            };
+            const __m128i cr16{
+                _mm_sub_epi16(half ? _mm_unpackhi_epi8(cr, zero) : _mm_unpacklo_epi8(cr, zero), chromaBias)
+            };
+            __m128i sums[3][2];
+            for (int quarter = 0; quarter < 2; ++quarter) {
+                const auto pair{[&](__m128i a, __m128i b) {
+                    return quarter ? _mm_unpackhi_epi16(a, b) : _mm_unpacklo_epi16(a, b);
+                }};
+                const __m128i yCb{pair(y16, cb16)};
+                sums[0][quarter] = _mm_add_epi32(_mm_madd_epi16(pair(y16, cr16), rCoeffs), rounding);
+                sums[1][quarter] =
+                    _mm_add_epi32(_mm_madd_epi16(yCb, gCoeffs), _mm_madd_epi16(pair(cr16, one), gCrCoeffs));
+                sums[2][quarter] = _mm_add_epi32(_mm_madd_epi16(yCb, bCoeffs), rounding);
+            }
+            for (int j = 0; j < 3; ++j) {
+                words[j][half] = _mm_packs_epi32(_mm_srai_epi32(sums[j][0], 8), _mm_srai_epi32(sums[j][1], 8));
+            }
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c0 + k), _mm_packus_epi16(words[0][0], words[0][1]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c1 + k), _mm_packus_epi16(words[1][0], words[1][1]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(c2 + k), _mm_packus_epi16(words[2][0], words[2][1]));
+    }
+    ycbcrToRgbScalar(c0 + k, c1 + k, c2 + k, count - k);
+}
+
+// The same on 32 pixels at a time. The unpacks and packs stay within lanes, so they cancel out.
+GLB_TARGET("avx2")
+void ycbcrToRgbAvx2(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    const __m256i zero{_mm256_setzero_si256()};
+    const __m256i lumaBias{_mm256_set1_epi16(16)}, chromaBias{_mm256_set1_epi16(128)}, one{_mm256_set1_epi16(1)};
+    const __m256i rCoeffs{_mm256_set1_epi32((409 << 16) | 298)};
+    const __m256i gCoeffs{_mm256_set1_epi32(static_cast<std::int32_t>((0xFFFFu & -100) << 16) | 298)};
+    const __m256i gCrCoeffs{_mm256_set1_epi32((128 << 16) | (0xFFFF & -208))};
+    const __m256i bCoeffs{_mm256_set1_epi32((516 << 16) | 298)};
+    const __m256i rounding{_mm256_set1_epi32(128)};
+    std::size_t k{0};
+    for (; k + 32 <= count; k += 32) {
+        const __m256i y{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c0 + k))};
+        const __m256i cb{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c1 + k))};
+        const __m256i cr{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(c2 + k))};
+        __m256i words[3][2];
+        for (int half = 0; half < 2; ++half) {
+            const auto widen{[&](__m256i v, __m256i bias) GLB_TARGET("avx2") {
+                return _mm256_sub_epi16(half ? _mm256_unpackhi_epi8(v, zero) : _mm256_unpacklo_epi8(v, zero), bias);
+            }};
+            const __m256i y16{widen(y, lumaBias)}, cb16{widen(cb, chromaBias)}, cr16{widen(cr, chromaBias)};
+            __m256i sums[3][2];
+            for (int quarter = 0; quarter < 2; ++quarter) {
+                const auto pair{[&](__m256i a, __m256i b) GLB_TARGET("avx2") {
+                    return quarter ? _mm256_unpackhi_epi16(a, b) : _mm256_unpacklo_epi16(a, b);
+                }};
+                const __m256i yCb{pair(y16, cb16)};
+                sums[0][quarter] = _mm256_add_epi32(_mm256_madd_epi16(pair(y16, cr16), rCoeffs), rounding);
+                sums[1][quarter] =
+                    _mm256_add_epi32(_mm256_madd_epi16(yCb, gCoeffs), _mm256_madd_epi16(pair(cr16, one), gCrCoeffs));
+                sums[2][quarter] = _mm256_add_epi32(_mm256_madd_epi16(yCb, bCoeffs), rounding);
+            }
+            for (int j = 0; j < 3; ++j) {
+                words[j][half] = _mm256_packs_epi32(_mm256_srai_epi32(sums[j][0], 8), _mm256_srai_epi32(sums[j][1], 8));
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(c0 + k), _mm256_packus_epi16(words[0][0], words[0][1]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(c1 + k), _mm256_packus_epi16(words[1][0], words[1][1]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(c2 + k), _mm256_packus_epi16(words[2][0], words[2][1]));
+    }
+    ycbcrToRgbSse2(c0 + k, c1 + k, c2 + k, count - k);
+}
+
+GLB_TARGET("avx2")
+inline __m256i reverse32(__m256i v) {
+    const __m256i mask{_mm256_setr_epi8(
+        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+    )};
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, mask), _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+GLB_TARGET("avx2")
+void reverseBytesAvx2(std::uint8_t *dst, const std::uint8_t *src, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + n - i - 32))};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), reverse32(v));
+    }
+    reverseBytesSse2(dst + i, src, n - i);
+}
+
+GLB_TARGET("avx2")
+void grayEncodeAvx2(std::uint8_t *dst, const std::uint8_t *src, std::size_t n, std::uint8_t before) {
+    const __m256i low7{_mm256_set1_epi8(0x7F)};
+    const __m256i high1{_mm256_set1_epi8(static_cast<char>(0x80))};
+    std::size_t k{n};
+    for (; k > 32; k -= 32) {
+        const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + k - 32))};
+        const __m256i prev{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + k - 33))};
+        const __m256i shifted{_mm256_and_si256(_mm256_srli_epi16(v, 1), low7)};
+        const __m256i carried{_mm256_and_si256(_mm256_slli_epi16(prev, 7), high1)};
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(dst + k - 32), _mm256_xor_si256(_mm256_xor_si256(v, shifted), carried)
+        );
+    }
+    grayEncodeSse2(dst, src, k, before);
+}
+
+/*
+    Four words per register, byte-swapped within their lanes so that lane 0 is the first one in
+    memory. The parities the lanes pass on are prefix XORed as a 4-bit mask, and lanes below an
+    odd parity are inverted.
+*/
+GLB_TARGET("avx2")
+bool grayDecodeAvx2(std::uint8_t *dst, const std::uint8_t *src, std::size_t n, bool parity) {
+    const __m256i swap{_mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    )};
+    const __m256i laneBits{_mm256_setr_epi64x(1, 2, 4, 8)};
+    std::size_t k{0};
+    for (; k + 32 <= n; k += 32) {
+        __m256i x{_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + k)), swap)};
+        for (int shift{1}; shift < 64; shift <<= 1) {
+            x = _mm256_xor_si256(x, _mm256_srli_epi64(x, shift));
+        }
+        unsigned lanes{static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(x, 63))))};
+        lanes ^= lanes << 1;
+        lanes ^= lanes << 2;
+        const unsigned flip{((lanes << 1) ^ (parity ? 0xF : 0)) & 0xF};
+        parity = (((lanes >> 3) ^ parity) & 1) != 0;
+        const __m256i mask{_mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(flip), laneBits), laneBits)};
+        x = _mm256_xor_si256(x, mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + k), _mm256_shuffle_epi8(x, swap));
+    }
+    return grayDecodeScalar(dst + k, src + k, n - k, parity);
+}
+
+/*
+    Carry lookahead across the lanes of a register. Reversing all of its bytes turns big-endian
+    limbs in memory order into native ones, least significant lane first. Per lane, g says a
+    carry (or borrow) leaves it whatever comes in and p that one coming in would pass through.
+    As bit masks, p + (g << 1 | carry in) then ripples every carry through runs of p lanes in a
+    single scalar add: a lane receives a carry exactly where that sum differs from p, and the bit
+    above the top lane is the carry out. g and p never overlap, so nothing reaches further.
+*/
+template <bool subtract>
+GLB_TARGET("avx2")
+std::uint64_t carryAvx2(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t carry, ChangeTracker &changes
+) {
+    constexpr const unsigned lanes{4};
+    const __m256i sign{_mm256_set1_epi64x(INT64_MIN)};
+    const __m256i ones{_mm256_set1_epi64x(-1)};
+    const __m256i laneBits{_mm256_setr_epi64x(1, 2, 4, 8)};
+    std::size_t i{n};
+    for (; i >= lanes; i -= lanes) {
+        std::uint64_t *block{dst + i - lanes};
+        const __m256i raw{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(block))};
+        const __m256i a{reverse32(raw)};
+        const __m256i b{reverse32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i - lanes)))};
+        // Unsigned compares are signed ones with the sign bits flipped.
+        __m256i result{}, generate{}, propagate{};
+        if constexpr (subtract) {
+            result = _mm256_sub_epi64(a, b);
+            generate = _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign), _mm256_xor_si256(a, sign));
+            propagate = _mm256_cmpeq_epi64(result, _mm256_setzero_si256());
+        } else {
+            result = _mm256_add_epi64(a, b);
+            generate = _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(result, sign));
+            propagate = _mm256_cmpeq_epi64(result, ones);
+        }
+        const unsigned g{static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(generate)))};
+        const unsigned p{static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(propagate)))};
+        const unsigned rippled{p + ((g << 1) | static_cast<unsigned>(carry))};
+        const unsigned received{(rippled ^ p) & ((1u << lanes) - 1)};
+        carry = (rippled >> lanes) & 1;
+        // All ones in the lanes that receive a carry, which adds or takes away one.
+        const __m256i mask{
+            _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(received), laneBits), laneBits)
+        };
+        result = subtract ? _mm256_add_epi64(result, mask) : _mm256_sub_epi64(result, mask);
+        const __m256i stored{reverse32(result)};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(block), stored);
+        const __m256i equal{_mm256_cmpeq_epi64(raw, stored)};
+        const unsigned same{static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(equal)))};
+        if (same != (1u << lanes) - 1) {
+            alignas(32) std::uint64_t diffs[lanes];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(diffs), _mm256_xor_si256(raw, stored));
+            changes.noteLanes(i - lanes, diffs, ~same & ((1u << lanes) - 1));
+        }
+    }
+    return carryScalar<subtract>(dst, src, i, carry, changes);
+}
+
+/*
+    Eight pixels per gather, fetched as dwords and packed down to 24 bytes. A dword read at the
+    very last pixel of src would run past its end, so lanes that close are left to the scalar loop.
+*/
+GLB_TARGET("avx2")
+void gatherPixelsAvx2(
+    std::uint8_t *dst, const std::uint8_t *src, std::size_t srcSize, const std::uint32_t *pixels, std::size_t count
+) {
+    const __m256i limit{_mm256_set1_epi32(static_cast<int>(srcSize - channels))};
+    const __m256i pack{_mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+    )};
+    const __m256i merge{_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7)};
+    std::size_t k{0};
+    for (; k + 8 <= count; k += 8) {
+        const __m256i pixel{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + k))};
+        const __m256i offset{_mm256_add_epi32(pixel, _mm256_add_epi32(pixel, pixel))};
+        const __m256i safe{_mm256_cmpgt_epi32(limit, offset)};
+        const __m256i words{_mm256_mask_i32gather_epi32(
+            _mm256_setzero_si256(), reinterpret_cast<const int *>(src), offset, safe, 1
+        )};
+        const __m256i packed{_mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(words, pack), merge)};
+        std::uint8_t *out{dst + channels * k};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(packed));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 16), _mm256_extracti128_si256(packed, 1));
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(safe)) != 0xFF) {
+            gatherPixelsScalar(out, src, srcSize, pixels + k, 8);
+        }
+    }
+    gatherPixelsScalar(dst + channels * k, src, srcSize, pixels + k, count - k);
+}
+
+GLB_TARGET("avx2")
+inline __m256i transposeBits(__m256i x) {
+    __m256i t{_mm256_xor_si256(x, _mm256_slli_epi64(x, 36))};
+    x = _mm256_xor_si256(
+        x, _mm256_and_si256(_mm256_set1_epi64x(0xF0F0'F0F0'0F0F'0F0F), _mm256_xor_si256(t, _mm256_srli_epi64(x, 36)))
+    );
+    t = _mm256_and_si256(_mm256_set1_epi64x(0xCCCC'0000'CCCC'0000), _mm256_xor_si256(x, _mm256_slli_epi64(x, 18)));
+    x = _mm256_xor_si256(x, _mm256_xor_si256(t, _mm256_srli_epi64(t, 18)));
+    t = _mm256_and_si256(_mm256_set1_epi64x(0xAA00'AA00'AA00'AA00), _mm256_xor_si256(x, _mm256_slli_epi64(x, 9)));
+    return _mm256_xor_si256(x, _mm256_xor_si256(t, _mm256_srli_epi64(t, 9)));
+}
+
+/*
+    32 groups at a time: the eight plane rows are interleaved into one word per group with three
+    rounds of unpacks, then every word is transposed in place. Unpacks stay within 128-bit lanes,
+    so the words come out as groups {0, 1, 16, 17}, {2, 3, 18, 19} and so on until the halves are
+    swapped back together for the stores.
+*/
+GLB_TARGET("avx2")
+void transposePlanesAvx2(std::uint8_t *dst, const std::uint8_t *src, std::size_t stride, std::size_t groups) {
+    std::size_t g{0};
+    for (; g + 32 <= groups; g += 32) {
+        __m256i rows[CHAR_BIT];
+        for (std::size_t s{0}; s < CHAR_BIT; ++s) {
+            rows[s] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + s * stride + g));
+        }
+        __m256i bytes[CHAR_BIT], words[CHAR_BIT];
+        for (std::size_t s{0}; s < CHAR_BIT; s += 2) {
+            bytes[s] = _mm256_unpacklo_epi8(rows[s], rows[s + 1]);
+            bytes[s + 1] = _mm256_unpackhi_epi8(rows[s], rows[s + 1]);
+        }
+        for (std::size_t s{0}; s < CHAR_BIT; s += 4) {
+            for (std::size_t half{0}; half < 2; ++half) {
+                words[s + 2 * half] = _mm256_unpacklo_epi16(bytes[s + half], bytes[s + 2 + half]);
+                words[s + 2 * half + 1] = _mm256_unpackhi_epi16(bytes[s + half], bytes[s + 2 + half]);
+            }
+        }
+        // words[k] and words[4 + k] now hold rows 0-3 and 4-7 of groups 4k to 4k + 3, per lane.
+        __m256i columns[CHAR_BIT];
+        for (std::size_t k{0}; k < 4; ++k) {
+            columns[2 * k] = transposeBits(_mm256_unpacklo_epi32(words[k], words[4 + k]));
+            columns[2 * k + 1] = transposeBits(_mm256_unpackhi_epi32(words[k], words[4 + k]));
+        }
+        for (std::size_t k{0}; k < 4; ++k) {
+            const __m256i low{_mm256_permute2x128_si256(columns[2 * k], columns[2 * k + 1], 0x20)};
+            const __m256i high{_mm256_permute2x128_si256(columns[2 * k], columns[2 * k + 1], 0x31)};
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + CHAR_BIT * (g + 4 * k)), low);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + CHAR_BIT * (g + 16 + 4 * k)), high);
+        }
+    }
+    transposePlanesScalar(dst + CHAR_BIT * g, src + g, stride, groups - g);
+}
+
+/*
+    Shifting words left by row brings bit 7 - row of both their bytes to the top, where movemask
+    collects it. Reversing each group of eight bytes first puts the first byte in the top bit.
+*/
+GLB_TARGET("avx2")
+void extractRowAvx2(std::uint8_t *dst, const std::uint8_t *src, unsigned row, std::size_t count) {
+    const __m256i reverse{_mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+    )};
+    const __m128i shift{_mm_cvtsi32_si128(static_cast<int>(row))};
+    std::size_t m{0};
+    for (; m + 4 <= count; m += 4) {
+        const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + CHAR_BIT * m))};
+        const __m256i top{_mm256_sll_epi16(_mm256_shuffle_epi8(v, reverse), shift)};
+        const std::uint32_t bits{static_cast<std::uint32_t>(_mm256_movemask_epi8(top))};
+        std::memcpy(dst + m, &bits, sizeof(bits));
+    }
+    extractRowScalar(dst + m, src + CHAR_BIT * m, row, count - m);
+}
+
+// Full 64-bit products of the 32-bit lanes of a and m, split into their high and low halves.
+GLB_TARGET("avx2")
+inline void mulHiLo(__m256i a, __m256i m, __m256i &hi, __m256i &lo) {
+    const __m256i even{_mm256_mul_epu32(a, m)};
+    const __m256i odd{_mm256_mul_epu32(_mm256_srli_epi64(a, 32), m)};
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Eight blocks at a time, one per lane, transposed back into block order on the way out.
+GLB_TARGET("avx2")
+void philoxAvx2(std::uint8_t *dst, std::uint64_t block, std::size_t blocks, std::uint64_t key) {
+    constexpr const std::size_t lanes{8};
+    const __m256i m0{_mm256_set1_epi32(static_cast<int>(philoxM0))};
+    const __m256i m1{_mm256_set1_epi32(static_cast<int>(philoxM1))};
+    const __m256i w0{_mm256_set1_epi32(static_cast<int>(philoxW0))};
+    const __m256i w1{_mm256_set1_epi32(static_cast<int>(philoxW1))};
+    const __m256i sign{_mm256_set1_epi32(INT32_MIN)};
+    std::size_t i{0};
+    for (; i + lanes <= blocks; i += lanes, block += lanes) {
+        const __m256i base{_mm256_set1_epi32(static_cast<int>(block))};
+        __m256i c0{_mm256_add_epi32(base, _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7))};
+        // Lanes whose low word wrapped around carry into the high one.
+        const __m256i wrapped{_mm256_cmpgt_epi32(_mm256_xor_si256(base, sign), _mm256_xor_si256(c0, sign))};
+        __m256i c1{_mm256_sub_epi32(_mm256_set1_epi32(static_cast<int>(block >> 32)), wrapped)};
+        __m256i c2{_mm256_setzero_si256()}, c3{_mm256_setzero_si256()};
+        __m256i k0{_mm256_set1_epi32(static_cast<int>(key))};
+        __m256i k1{_mm256_set1_epi32(static_cast<int>(key >> 32))};
+        for (unsigned r{0}; r < philoxRounds; ++r) {
+            __m256i hi0{}, lo0{}, hi1{}, lo1{};
+            mulHiLo(c0, m0, hi0, lo0);
+            mulHiLo(c2, m1, hi1, lo1);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), k0);
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), k1);
+            c1 = lo1;
+            c3 = lo0;
+            k0 = _mm256_add_epi32(k0, w0);
+            k1 = _mm256_add_epi32(k1, w1);
+        }
+        const __m256i t0{_mm256_unpacklo_epi32(c0, c1)}, t1{_mm256_unpackhi_epi32(c0, c1)};
+        const __m256i t2{_mm256_unpacklo_epi32(c2, c3)}, t3{_mm256_unpackhi_epi32(c2, c3)};
+        // Blocks 0 and 4, 1 and 5, 2 and 6, 3 and 7.
+        const __m256i b04{_mm256_unpacklo_epi64(t0, t2)}, b15{_mm256_unpackhi_epi64(t0, t2)};
+        const __m256i b26{_mm256_unpacklo_epi64(t1, t3)}, b37{_mm256_unpackhi_epi64(t1, t3)};
+        __m256i *out{reinterpret_cast<__m256i *>(dst + i * philoxBlockBytes)};
+        _mm256_storeu_si256(out, _mm256_permute2x128_si256(b04, b15, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(b26, b37, 0x20));
+        _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(b04, b15, 0x31));
+        _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(b26, b37, 0x31));
+    }
+    philoxScalar(dst + i * philoxBlockBytes, block, blocks - i, key);
+}
+
+GLB_TARGET("avx512f,avx512bw")
+inline __m512i reverse64(__m512i v) {
+    const __m512i mask{_mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))};
+    const __m512i lanes{_mm512_shuffle_epi8(v, mask)};
+    return _mm512_shuffle_i64x2(lanes, lanes, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+GLB_TARGET("avx512f,avx512bw")
+void reverseBytesAvx512(std::uint8_t *dst, const std::uint8_t *src, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 64 <= n; i += 64) {
+        _mm512_storeu_si512(dst + i, reverse64(_mm512_loadu_si512(src + n - i - 64)));
+    }
+    reverseBytesAvx2(dst + i, src, n - i);
+}
+
+GLB_TARGET("avx512f,avx512bw")
+void grayEncodeAvx512(std::uint8_t *dst, const std::uint8_t *src, std::size_t n, std::uint8_t before) {
+    const __m512i low7{_mm512_set1_epi8(0x7F)};
+    const __m512i high1{_mm512_set1_epi8(static_cast<char>(0x80))};
+    std::size_t k{n};
+    for (; k > 64; k -= 64) {
+        const __m512i v{_mm512_loadu_si512(src + k - 64)};
+        const __m512i shifted{_mm512_and_si512(_mm512_srli_epi16(v, 1), low7)};
+        const __m512i carried{_mm512_and_si512(_mm512_slli_epi16(_mm512_loadu_si512(src + k - 65), 7), high1)};
+        _mm512_storeu_si512(dst + k - 64, _mm512_xor_si512(_mm512_xor_si512(v, shifted), carried));
+    }
+    grayEncodeAvx2(dst, src, k, before);
+}
+
+// As carryAvx2, eight lanes at a time with compares straight into mask registers.
+template <bool subtract>
+GLB_TARGET("avx512f,avx512bw")
+std::uint64_t carryAvx512(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t carry, ChangeTracker &changes
+) {
+    constexpr const unsigned lanes{8};
+    const __m512i ones{_mm512_set1_epi64(-1)};
+    std::size_t i{n};
+    for (; i >= lanes; i -= lanes) {
+        std::uint64_t *block{dst + i - lanes};
+        const __m512i raw{_mm512_loadu_si512(block)};
+        const __m512i a{reverse64(raw)};
+        const __m512i b{reverse64(_mm512_loadu_si512(src + i - lanes))};
+        __m512i result{};
+        __mmask8 generate{}, propagate{};
+        if constexpr (subtract) {
+            result = _mm512_sub_epi64(a, b);
+            generate = _mm512_cmplt_epu64_mask(a, b);
+            propagate = _mm512_cmpeq_epi64_mask(result, _mm512_setzero_si512());
+        } else {
+            result = _mm512_add_epi64(a, b);
+            generate = _mm512_cmplt_epu64_mask(result, a);
+            propagate = _mm512_cmpeq_epi64_mask(result, ones);
+        }
+        const unsigned p{propagate};
+        const unsigned rippled{p + ((static_cast<unsigned>(generate) << 1) | static_cast<unsigned>(carry))};
+        const __mmask8 received{static_cast<__mmask8>(rippled ^ p)};
+        carry = (rippled >> lanes) & 1;
+        result = subtract ? _mm512_mask_add_epi64(result, received, result, ones)
+                          : _mm512_mask_sub_epi64(result, received, result, ones);
+        const __m512i stored{reverse64(result)};
+        _mm512_storeu_si512(block, stored);
+        const unsigned changed{_mm512_cmpneq_epu64_mask(raw, stored)};
+        if (changed != 0) {
+            alignas(64) std::uint64_t diffs[lanes];
+            _mm512_store_si512(diffs, _mm512_xor_si512(raw, stored));
+            changes.noteLanes(i - lanes, diffs, changed);
+        }
+    }
+    return carryAvx2<subtract>(dst, src, i, carry, changes);
+}
+#endif
+
+/*
+    Every kernel comes in the tiers it benefits from, the pick takes the widest one not above
+    cpuTier(). Tiers a kernel skips use the next narrower one. Each entry point keeps its pick in a
+    function-local static, like cpuTier() does, so that a kernel called while another file's
+    statics are being initialized is never an unset pointer.
+*/
+ColorConvert pickHsv() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return hsvToRgbAvx2;
+    }
+    if (cpuTier() >= CpuTier::SSE2) {
+        return hsvToRgbSse2;
+    }
+#endif
+    return hsvToRgbScalar;
+}
+
+ColorConvert pickYCbCr() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return ycbcrToRgbAvx2;
+    }
+    if (cpuTier() >= CpuTier::SSE2) {
+        return ycbcrToRgbSse2;
+    }
+#endif
+    return ycbcrToRgbScalar;
+}
+
+template <bool reversed>
+Deinterleave pickDeinterleave() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return deinterleaveAvx2<reversed>;
+    }
+    if (cpuTier() >= CpuTier::SSSE3) {
+        return deinterleaveSsse3<reversed>;
+    }
+#endif
+    return deinterleaveScalar<reversed>;
+}
+
+ReverseBytes pickReverse() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX512) {
+        return reverseBytesAvx512;
+    }
+    if (cpuTier() >= CpuTier::AVX2) {
+        return reverseBytesAvx2;
+    }
+    if (cpuTier() >= CpuTier::SSE2) {
+        return reverseBytesSse2;
+    }
+#endif
+    return reverseBytesScalar;
+}
+
+GrayEncode pickGray() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX512) {
+        return grayEncodeAvx512;
+    }
+    if (cpuTier() >= CpuTier::AVX2) {
+        return grayEncodeAvx2;
+    }
+    if (cpuTier() >= CpuTier::SSE2) {
+        return grayEncodeSse2;
+    }
+#endif
+    return grayEncodeScalar;
+}
+
+GrayDecode pickGrayDecode() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return grayDecodeAvx2;
+    }
+#endif
+    return grayDecodeScalar;
+}
+
+TransposePlanes pickTransposePlanes() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return transposePlanesAvx2;
+    }
+#endif
+    return transposePlanesScalar;
+}
+
+ExtractRow pickExtractRow() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return extractRowAvx2;
+    }
+#endif
+    return extractRowScalar;
+}
+
+GatherPixels pickGatherPixels() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return gatherPixelsAvx2;
+    }
+#endif
+    return gatherPixelsScalar;
+}
+
+// SSE2 has no 64-bit compares, so the carry chain goes straight from scalar to AVX2.
+PhiloxBlocks pickPhilox() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX2) {
+        return philoxAvx2;
+    }
+#endif
+    return philoxScalar;
+}
+
+template <bool subtract>
+CarryKernel pickCarry() {
+#ifdef GLB_SSE2
+    if (cpuTier() >= CpuTier::AVX512) {
+        return carryAvx512<subtract>;
+    }
+    if (cpuTier() >= CpuTier::AVX2) {
+        return carryAvx2<subtract>;
+    }
+#endif
+    return carryScalar<subtract>;
+}
+
+/*
+    The threads grayDecode and philoxFill split large inputs over, started the first time they are
+    needed and kept until exit, so that a call costs a wake-up rather than thread creation and
+    allocates nothing. One split runs at a time; a call arriving while another holds the pool
+    does its whole share on its own thread instead of waiting.
+*/
+class WorkerPool {
+  private:
+    using TaskFn = void (*)(const void *, std::size_t);
+
+    std::mutex callMutex{}; // Held by the caller whose split is running.
+    std::mutex mutex{}; // Guards everything below.
+    std::condition_variable_any wake{};
+    std::condition_variable done{};
+    std::uint64_t generation{0}; // Bumped for every split, the signal for workers to look at it.
+    std::size_t parts{0};
+    std::size_t pending{0}; // Parts handed to workers and not finished yet.
+    TaskFn fn{};
+    const void *task{};
+    std::size_t started{0};
+    // Last, so the threads are stopped and joined before the state they wait on goes away.
+    std::array<std::jthread, maxWorkers - 1> threads{};
+
+    void work(std::stop_token stop, std::size_t part, std::uint64_t seen) {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (wake.wait(lock, stop, [&] { return generation != seen; })) {
+            seen = generation;
+            if (part < parts) {
+                lock.unlock();
+                fn(task, part);
+                lock.lock();
+                if (--pending == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+    }
+
+    void dispatch(std::size_t count, TaskFn taskFn, const void *taskData) {
+        {
+            const std::lock_guard<std::mutex> lock{mutex};
+            for (; started + 1 < count; ++started) {
+                threads[started] = std::jthread{
+                    [this, part = started + 1, seen = generation](std::stop_token stop) { work(stop, part, seen); }
+                };
+            }
+            fn = taskFn;
+            task = taskData;
+            parts = count;
+            pending = count - 1;
+            ++generation;
+        }
+        wake.notify_all();
+        taskFn(taskData, 0);
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [&] { return pending == 0; });
+    }
+
+  public:
+    // Calls part(p) for every p in [0, count), count at most maxWorkers, part 0 on this thread.
+    template <typename Part>
+    void run(std::size_t count, const Part &part) {
+        std::unique_lock<std::mutex> call{callMutex, std::try_to_lock};
+        if (count <= 1 || !call.owns_lock()) {
+            for (std::size_t p{0}; p < count; ++p) {
+                part(p);
+            }
+            return;
+        }
+        dispatch(count, [](const void *data, std::size_t p) { (*static_cast<const Part *>(data))(p); }, &part);
+    }
+};
+
+WorkerPool &workerPool() {
+    static WorkerPool pool{};
+    return pool;
+}
+
+} // namespace
+
+void reverseBytes(std::uint8_t *dst, const std::uint8_t *src, std::size_t n) {
+    static const ReverseBytes impl{pickReverse()};
+    impl(dst, src, n);
+}
+
+void grayEncode(std::uint8_t *dst, const std::uint8_t *src, std::size_t n, std::uint8_t before) {
+    static const GrayEncode impl{pickGray()};
+    impl(dst, src, n, before);
+}
+
+void grayDecode(std::uint8_t *dst, const std::uint8_t *src, std::size_t n) {
+    static const GrayDecode impl{pickGrayDecode()};
+    /*
+        Each chunk only needs the parity of everything before it. The chunks' own parities come
+        from one parallel pass, a scan over them gives every chunk its starting parity, and a
+        second parallel pass decodes. Both passes only stream through memory.
+    */
+    const std::size_t workers{std::clamp<std::size_t>(
+        std::min<std::size_t>(std::thread::hardware_concurrency(), n / minDecodeChunk), 1, maxWorkers
+    )};
+    const std::size_t chunk{(n / workers) & ~(alignof(std::max_align_t) - 1)};
+    const auto begin{[&](std::size_t w) { return w * chunk; }};
+    const auto size{[&](std::size_t w) { return w + 1 == workers ? n - begin(w) : chunk; }};
+    std::array<bool, maxWorkers> parity{};
+    // The last chunk's parity is not needed by anyone.
+    workerPool().run(workers - 1, [&](std::size_t w) { parity[w] = xorParity(src + begin(w), size(w)); });
+    bool before{false};
+    for (std::size_t w{0}; w < workers; ++w) {
+        before = std::exchange(parity[w], before) != before;
+    }
+    workerPool().run(workers, [&](std::size_t w) {
+        impl(dst + begin(w), src + begin(w), size(w), parity[w]);
+    });
+}
+
+void philoxFill(std::uint8_t *dst, std::size_t n, std::uint64_t key) {
+    static const PhiloxBlocks impl{pickPhilox()};
+    const std::size_t blocks{n / philoxBlockBytes};
+    const std::size_t workers{std::clamp<std::size_t>(
+        std::min<std::size_t>(std::thread::hardware_concurrency(), n / minRandomChunk), 1, maxWorkers
+    )};
+    const std::size_t chunk{blocks / workers};
+    workerPool().run(workers, [&](std::size_t w) {
+        const std::size_t first{w * chunk};
+        const std::size_t count{w + 1 == workers ? blocks - first : chunk};
+        impl(dst + first * philoxBlockBytes, first, count, key);
+    });
+    if (n % philoxBlockBytes != 0) {
+        std::uint8_t last[philoxBlockBytes];
+        impl(last, blocks, 1, key);
+        std::memcpy(dst + blocks * philoxBlockBytes, last, n % philoxBlockBytes);
+    }
+}
+
+void gatherPixels(
+    std::uint8_t *dst, const std::uint8_t *src, std::size_t srcSize, const std::uint32_t *pixels, std::size_t count
+) {
+    static const GatherPixels impl{pickGatherPixels()};
+    impl(dst, src, srcSize, pixels, count);
+}
+
+void transposeBitPlanes(std::uint8_t *dst, const std::uint8_t *src, std::size_t stride, std::size_t groups) {
+    static const TransposePlanes impl{pickTransposePlanes()};
+    impl(dst, src, stride, groups);
+}
+
+void extractBitRow(std::uint8_t *dst, const std::uint8_t *src, unsigned row, std::size_t count) {
+    static const ExtractRow impl{pickExtractRow()};
+    impl(dst, src, row, count);
+}
+
+std::uint64_t addLimbs(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t carry, ByteRange &changed
+) {
+    static const CarryKernel impl{pickCarry<false>()};
+    ChangeTracker changes{};
+    carry = impl(dst, src, n, carry, changes);
+    changed = changes.range();
+    return carry;
+}
+
+std::uint64_t subLimbs(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t borrow, ByteRange &changed
+) {
+    static const CarryKernel impl{pickCarry<true>()};
+    ChangeTracker changes{};
+    borrow = impl(dst, src, n, borrow, changes);
+    changed = changes.range();
+    return borrow;
+}
+
+std::uint64_t addMulLimbs(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t k, ByteRange &changed
+) {
+    ChangeTracker changes{};
+    const std::uint64_t carry{mulCarryScalar<false>(dst, src, n, k, changes)};
+    changed = changes.range();
+    return carry;
+}
+
+std::uint64_t subMulLimbs(
+    std::uint64_t *dst, const std::uint64_t *src, std::size_t n, std::uint64_t k, ByteRange &changed
+) {
+    ChangeTracker changes{};
+    const std::uint64_t borrow{mulCarryScalar<true>(dst, src, n, k, changes)};
+    changed = changes.range();
+    return borrow;
+}
+
+void hsvToRgb(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    static const ColorConvert impl{pickHsv()};
+    impl(c0, c1, c2, count);
+}
+
+void ycbcrToRgb(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, std::size_t count) {
+    static const ColorConvert impl{pickYCbCr()};
+    impl(c0, c1, c2, count);
+}
+
+void deinterleave3(std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, const std::uint8_t *src, std::size_t count) {
+    static const Deinterleave impl{pickDeinterleave<false>()};
+    impl(c0, c1, c2, src, count);
+}
+
+void deinterleave3Reversed(
+    std::uint8_t *c0, std::uint8_t *c1, std::uint8_t *c2, const std::uint8_t *src, std::size_t count
+) {
+    static const Deinterleave impl{pickDeinterleave<true>()};
+    impl(c0, c1, c2, src, count);
+}
+
+} // namespace glb
@@ -0,0 +1,97 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#endif
+
+#include "glb_mapping.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace glb {
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::filesystem::path &path) {
+    close();
+    fileHandle = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        return false;
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    view = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        close();
+        return false;
+    }
+    bytes = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (view) {
+        UnmapViewOfFile(view);
+        view = nullptr;
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+    bytes = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path &path) {
+    close();
+    const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd < 0) {
+        return false;
+    }
+    // The mapping holds its own reference to the file, so the descriptor can go right away.
+    struct stat status{};
+    void *mapped{MAP_FAILED};
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        mapped = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    view = mapped;
+    bytes = static_cast<std::size_t>(status.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (view) {
+        munmap(const_cast<void *>(view), bytes);
+        view = nullptr;
+    }
+    bytes = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+} // namespace glb
@@ -0,0 +1,204 @@
+#include "glb_permutation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <system_error>
+
+namespace glb {
+
+namespace {
+
+constexpr const std::uint32_t width{imgWidth};
+constexpr const std::uint32_t height{imgHeight};
+constexpr const std::uint32_t tileSide{16};
+
+int sign(int v) { return (v > 0) - (v < 0); }
+
+/*
+    Generalized Hilbert curve ("gilbert", Jakub Cerveny) over the rectangle spanned from (x, y)
+    by the major axis a and the minor axis b. Unlike the textbook curve it needs no power of two
+    square, and for even sides every step moves to a neighbouring pixel. The halvings round
+    towards negative infinity, which the arithmetic shifts do.
+*/
+void gilbert(std::vector<std::uint32_t> &curve, int x, int y, int ax, int ay, int bx, int by) {
+    const int w{std::abs(ax + ay)}, h{std::abs(bx + by)};
+    const int dax{sign(ax)}, day{sign(ay)}, dbx{sign(bx)}, dby{sign(by)};
+    if (h == 1 || w == 1) {
+        const int steps{h == 1 ? w : h};
+        const int dx{h == 1 ? dax : dbx}, dy{h == 1 ? day : dby};
+        for (int i{0}; i < steps; ++i, x += dx, y += dy) {
+            curve.push_back(static_cast<std::uint32_t>(y) * width + static_cast<std::uint32_t>(x));
+        }
+        return;
+    }
+    int ax2{ax >> 1}, ay2{ay >> 1}, bx2{bx >> 1}, by2{by >> 1};
+    const int w2{std::abs(ax2 + ay2)}, h2{std::abs(bx2 + by2)};
+    if (2 * w > 3 * h) {
+        // Long and thin: split along the major axis only, keeping the halves' sides even.
+        if ((w2 & 1) && w > 2) {
+            ax2 += dax;
+            ay2 += day;
+        }
+        gilbert(curve, x, y, ax2, ay2, bx, by);
+        gilbert(curve, x + ax2, y + ay2, ax - ax2, ay - ay2, bx, by);
+        return;
+    }
+    if ((h2 & 1) && h > 2) {
+        bx2 += dbx;
+        by2 += dby;
+    }
+    gilbert(curve, x, y, bx2, by2, ax2, ay2);
+    gilbert(curve, x + bx2, y + by2, ax, ay, bx - bx2, by - by2);
+    gilbert(
+        curve, x + (ax - dax) + (bx2 - dbx), y + (ay - day) + (by2 - dby), -bx2, -by2, -(ax - ax2), -(ay - ay2)
+    );
+}
+
+std::vector<std::uint32_t> hilbertCurve() {
+    std::vector<std::uint32_t> curve{};
+    curve.reserve(PixelPermutation::pixelCount);
+    gilbert(curve, 0, 0, static_cast<int>(width), 0, 0, static_cast<int>(height));
+    return curve;
+}
+
+// Z-order over the next power of two square, skipping the codes that fall outside the image.
+std::vector<std::uint32_t> mortonCurve() {
+    std::vector<std::uint32_t> curve{};
+    curve.reserve(PixelPermutation::pixelCount);
+    const std::uint32_t side{std::bit_ceil(std::max(width, height))};
+    for (std::uint64_t code{0}; code < std::uint64_t{side} * side; ++code) {
+        std::uint32_t x{0}, y{0};
+        for (unsigned bit{0}; (std::uint32_t{1} << bit) < side; ++bit) {
+            x |= static_cast<std::uint32_t>((code >> (2 * bit)) & 1) << bit;
+            y |= static_cast<std::uint32_t>((code >> (2 * bit + 1)) & 1) << bit;
+        }
+        if (x < width && y < height) {
+            curve.push_back(y * width + x);
+        }
+    }
+    return curve;
+}
+
+// Row-major tiles, each one filled row-major before the next.
+std::vector<std::uint32_t> tiledCurve() {
+    std::vector<std::uint32_t> curve{};
+    curve.reserve(PixelPermutation::pixelCount);
+    for (std::uint32_t ty{0}; ty < height; ty += tileSide) {
+        for (std::uint32_t tx{0}; tx < width; tx += tileSide) {
+            for (std::uint32_t y{ty}; y < std::min(ty + tileSide, height); ++y) {
+                for (std::uint32_t x{tx}; x < std::min(tx + tileSide, width); ++x) {
+                    curve.push_back(y * width + x);
+                }
+            }
+        }
+    }
+    return curve;
+}
+
+const PixelPermutation &builtin(
+    std::once_flag &once, PixelPermutation &table, std::vector<std::uint32_t> (*make)()
+) {
+    std::call_once(once, [&] { table.assignOrder(make()); });
+    return table;
+}
+
+// Built on first use, so that the identity layout exists before anyone can ask for it.
+std::atomic<std::shared_ptr<const PixelPermutation>> &customLayout() {
+    static std::atomic<std::shared_ptr<const PixelPermutation>> layout{[] {
+        auto identity{std::make_shared<PixelPermutation>()};
+        std::vector<std::uint32_t> order(PixelPermutation::pixelCount);
+        std::iota(order.begin(), order.end(), 0);
+        identity->assignOrder(std::move(order));
+        return std::shared_ptr<const PixelPermutation>{std::move(identity)};
+    }()};
+    return layout;
+}
+
+} // namespace
+
+bool PixelPermutation::invert() {
+    inverse.assign(pixelCount, UINT32_MAX);
+    for (std::uint32_t q{0}; q < pixelCount; ++q) {
+        const std::uint32_t n{table[q]};
+        if (n >= pixelCount || inverse[n] != UINT32_MAX) {
+            inverse.clear();
+            return false;
+        }
+        inverse[n] = q;
+    }
+    return true;
+}
+
+void PixelPermutation::assignOrder(std::vector<std::uint32_t> curve) {
+    close();
+    inverse = std::move(curve);
+    owned.assign(pixelCount, 0);
+    for (std::uint32_t n{0}; n < pixelCount; ++n) {
+        owned[inverse[n]] = n;
+    }
+    table = owned.data();
+}
+
+bool PixelPermutation::map(const std::filesystem::path &path) {
+    close();
+    std::error_code ec{};
+    if (std::filesystem::file_size(path, ec) != pixelCount * sizeof(std::uint32_t) || ec) {
+        return false;
+    }
+    if (!file.open(path) || file.size() != pixelCount * sizeof(std::uint32_t)) {
+        close();
+        return false;
+    }
+    table = static_cast<const std::uint32_t *>(file.data());
+    if (!invert()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PixelPermutation::close() {
+    table = nullptr;
+    owned.clear();
+    inverse.clear();
+    file.close();
+}
+
+PixelPermutation::~PixelPermutation() { close(); }
+
+const PixelPermutation &hilbertPermutation() {
+    static std::once_flag once{};
+    static PixelPermutation table{};
+    return builtin(once, table, hilbertCurve);
+}
+
+const PixelPermutation &mortonPermutation() {
+    static std::once_flag once{};
+    static PixelPermutation table{};
+    return builtin(once, table, mortonCurve);
+}
+
+const PixelPermutation &tiledPermutation() {
+    static std::once_flag once{};
+    static PixelPermutation table{};
+    return builtin(once, table, tiledCurve);
+}
+
+std::shared_ptr<const PixelPermutation> customPermutation() {
+    return customLayout().load(std::memory_order_acquire);
+}
+
+bool loadCustomPermutation(const std::filesystem::path &path) {
+    auto loaded{std::make_shared<PixelPermutation>()};
+    if (!loaded->map(path)) {
+        return false;
+    }
+    customLayout().store(std::move(loaded), std::memory_order_release);
+    return true;
+}
+
+} // namespace glb
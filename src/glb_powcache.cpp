@@ -0,0 +1,174 @@
+#include "glb_powcache.hpp"
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace glb {
+
+namespace {
+
+constexpr const std::uint64_t fileMagic{0x3130'5750'4F50'4C47}; // "GLPOPW01"
+constexpr const std::uint64_t recordMagic{0x4452'4345'5230'3150}; // "P10RECRD"
+// A full cache stops growing. Anything larger on disk is not ours, or damaged, and gets replaced.
+constexpr const std::uintmax_t maxFileBytes{std::uintmax_t{128} << 20};
+
+struct RecordHeader {
+    std::uint64_t magic{};
+    std::uint64_t exponent{};
+    std::uint64_t limbCount{};
+    std::uint64_t checksum{};
+};
+
+// Word-wise FNV-1a. Only has to catch truncated writes and bit rot, not adversaries.
+std::uint64_t checksum(std::uint64_t exponent, const std::uint64_t *limbs, std::size_t n) {
+    constexpr const std::uint64_t prime{0x0000'0100'0000'01B3};
+    std::uint64_t hash{0xCBF2'9CE4'8422'2325 ^ exponent};
+    for (std::size_t i{0}; i < n; ++i) {
+        hash = (hash ^ limbs[i]) * prime;
+    }
+    return hash;
+}
+
+} // namespace
+
+void PowerCache::open(const std::filesystem::path &path) {
+    const std::lock_guard lock{mutex};
+    close();
+    filePath = path;
+    std::error_code ec{};
+    const std::uintmax_t size{std::filesystem::file_size(path, ec)};
+    fileBytes = 0;
+    if (ec) {
+        return;
+    }
+    if (size > maxFileBytes || size < sizeof(fileMagic)) {
+        std::filesystem::remove(path, ec);
+        return;
+    }
+    if (!file.open(path) || file.size() != size) {
+        close();
+        return;
+    }
+    const std::uint8_t *bytes{static_cast<const std::uint8_t *>(file.data())};
+    std::uint64_t magic{};
+    std::memcpy(&magic, bytes, sizeof(magic));
+    if (magic != fileMagic) {
+        close();
+        std::filesystem::remove(path, ec);
+        return;
+    }
+    // A torn or foreign tail would hide anything appended after it, so such a file starts over.
+    std::size_t offset{sizeof(fileMagic)};
+    while (offset + sizeof(RecordHeader) <= size) {
+        RecordHeader header{};
+        std::memcpy(&header, bytes + offset, sizeof(header));
+        const std::size_t available{(size - offset - sizeof(header)) / sizeof(std::uint64_t)};
+        if (header.magic != recordMagic || header.limbCount > available) {
+            break;
+        }
+        const std::size_t limbBytes{header.limbCount * sizeof(std::uint64_t)};
+        mapped[header.exponent] = Record{
+            header.exponent, reinterpret_cast<const std::uint64_t *>(bytes + offset + sizeof(header)),
+            header.limbCount, false
+        };
+        offset += sizeof(header) + limbBytes;
+    }
+    if (offset != size) {
+        close();
+        std::filesystem::remove(path, ec);
+        return;
+    }
+    fileBytes = size;
+}
+
+std::optional<BigNat> PowerCache::find(std::uint64_t exponent) {
+    const std::lock_guard lock{mutex};
+    if (const auto it{fresh.find(exponent)}; it != fresh.end()) {
+        return it->second;
+    }
+    const auto it{mapped.find(exponent)};
+    if (it == mapped.end()) {
+        return std::nullopt;
+    }
+    Record &record{it->second};
+    if (!record.validated) {
+        RecordHeader header{};
+        std::memcpy(&header, reinterpret_cast<const std::uint8_t *>(record.limbs) - sizeof(header), sizeof(header));
+        if (header.checksum != checksum(record.exponent, record.limbs, record.limbCount)) {
+            mapped.erase(it);
+            return std::nullopt;
+        }
+        record.validated = true;
+    }
+    BigNat value{};
+    value.limbs.assign(record.limbs, record.limbs + record.limbCount);
+    return value;
+}
+
+std::optional<std::uint64_t> PowerCache::floorExponent(std::uint64_t exponent) {
+    const std::lock_guard lock{mutex};
+    std::optional<std::uint64_t> best{};
+    if (const auto it{mapped.upper_bound(exponent)}; it != mapped.begin()) {
+        best = std::prev(it)->first;
+    }
+    if (const auto it{fresh.upper_bound(exponent)}; it != fresh.begin() && (!best || std::prev(it)->first > *best)) {
+        best = std::prev(it)->first;
+    }
+    return best;
+}
+
+void PowerCache::store(std::uint64_t exponent, const BigNat &value) {
+    /*
+        Only the checkpoints are kept. Every other power is built from them in a few
+        multiplications, while keeping each slider position would fill the budget with values
+        that are unlikely to be asked for again.
+    */
+    if (!std::has_single_bit(exponent)) {
+        return;
+    }
+    const std::lock_guard lock{mutex};
+    std::uintmax_t recordBytes{sizeof(RecordHeader) + value.limbs.size() * sizeof(std::uint64_t)};
+    if (filePath.empty() || fresh.contains(exponent) || mapped.contains(exponent) ||
+        fileBytes + recordBytes > maxFileBytes) {
+        return;
+    }
+    std::error_code ec{};
+    const std::uintmax_t sizeBefore{std::filesystem::file_size(filePath, ec)};
+    const bool exists{!ec};
+    std::ofstream out{filePath, std::ios::binary | std::ios::app};
+    if (!exists) {
+        out.write(reinterpret_cast<const char *>(&fileMagic), sizeof(fileMagic));
+        recordBytes += sizeof(fileMagic);
+    }
+    const RecordHeader header{
+        recordMagic, exponent, value.limbs.size(), checksum(exponent, value.limbs.data(), value.limbs.size())
+    };
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(
+        reinterpret_cast<const char *>(value.limbs.data()),
+        static_cast<std::streamsize>(value.limbs.size() * sizeof(std::uint64_t))
+    );
+    out.flush();
+    out.close();
+    if (!out.good()) {
+        // A torn record would make the next open() discard the whole file, so it is cut off again.
+        if (exists) {
+            std::filesystem::resize_file(filePath, sizeBefore, ec);
+        } else {
+            std::filesystem::remove(filePath, ec);
+        }
+        return;
+    }
+    fresh[exponent] = value;
+    fileBytes += recordBytes;
+}
+
+void PowerCache::close() {
+    mapped.clear();
+    file.close();
+}
+
+PowerCache::~PowerCache() { close(); }
+
+} // namespace glb
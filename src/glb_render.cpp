@@ -0,0 +1,374 @@
+#include "glb_render.hpp"
+#include "glb_kernels.hpp"
+#include "glb_permutation.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace glb {
+
+namespace {
+
+constexpr const std::size_t planeSize{imgWidth * imgHeight};
+constexpr const std::size_t textureBytes{planeSize * imgCh};
+// An eighth of the index, one bit plane of the texture for the bit-level modes.
+constexpr const std::size_t segmentBytes{textureBytes / CHAR_BIT};
+// One texture row per channel, small enough to stay in L1 between gathering and converting.
+constexpr const std::size_t blockPixels{imgWidth};
+
+using Planes = std::array<std::uint8_t *, imgCh>;
+
+/*
+    One policy per spatial interpretation. ranges() replaces the contents of out with the bytes of
+    the interpretation that depend on idx[changed], a few contiguous runs per mode; a pixel is the
+    smallest unit planar modes can redraw. gather() writes channel j of pixels [first, first + count), that is
+    bytes jP + first + k of what the spatial mode alone would produce, into out[j].
+    A mode without a specialization fails to compile as soon as the dispatch table is built.
+*/
+template <SpatialInterpretation sp>
+struct SpatialPolicy;
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::INTERLEAVED> {
+    static void ranges(ByteRange changed, std::vector<ByteRange> &out) { out.assign(1, changed); }
+    static void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) {
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            std::memcpy(out[j], idx + planeSize * j + first, count);
+        }
+    }
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::INTERLEAVED_REVERSED> {
+    static void ranges(ByteRange changed, std::vector<ByteRange> &out) {
+        out.assign(1, ByteRange{textureBytes - changed.end, textureBytes - changed.begin});
+    }
+    static void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) {
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            reverseBytes(out[j], idx + (textureBytes - (planeSize * j + first + count)), count);
+        }
+    }
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::PLANAR> {
+    static void ranges(ByteRange changed, std::vector<ByteRange> &out) {
+        const std::size_t firstPixel{changed.begin / imgCh};
+        const std::size_t lastPixel{(changed.end + imgCh - 1) / imgCh};
+        out.clear();
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            out.push_back(ByteRange{planeSize * j + firstPixel, planeSize * j + lastPixel});
+        }
+    }
+    static void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) {
+        deinterleave3(out[0], out[1], out[2], idx + first * imgCh, count);
+    }
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::PLANAR_REVERSED> {
+    static void ranges(ByteRange changed, std::vector<ByteRange> &out) {
+        const std::size_t firstPixel{changed.begin / imgCh};
+        const std::size_t lastPixel{(changed.end + imgCh - 1) / imgCh};
+        out.clear();
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            const std::size_t planeEnd{textureBytes - planeSize * j};
+            out.push_back(ByteRange{planeEnd - lastPixel, planeEnd - firstPixel});
+        }
+    }
+    // Reversing the planar image swaps the planes around and mirrors the pixels within them.
+    static void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) {
+        deinterleave3Reversed(out[0], out[1], out[2], idx + (planeSize - first - count) * imgCh, count);
+    }
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::GRAY_CODE> {
+    // Gray code also reaches one byte further through i >> 1.
+    static void ranges(ByteRange changed, std::vector<ByteRange> &out) {
+        out.assign(1, ByteRange{changed.begin, std::min(changed.end + 1, textureBytes)});
+    }
+    static void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) {
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            const std::size_t i{planeSize * j + first};
+            grayEncode(out[j], idx + i, count, i != 0 ? idx[i - 1] : 0);
+        }
+    }
+};
+
+/*
+    Bit k of texture byte b is index bit (7 - k) * 8 * segmentBytes + b: the index is cut into
+    eight planes and each supplies one bit of every byte, most significant plane first. Byte b
+    then gathers its bits from byte b / 8 of every plane through 8x8 bit transposes.
+*/
+template <>
+struct SpatialPolicy<SpatialInterpretation::BIT_PLANAR> {
+    static void ranges(ByteRange changed, std::vector<ByteRange> &out) {
+        out.clear();
+        for (std::size_t s = 0; s < CHAR_BIT; ++s) {
+            const std::size_t first{std::max(changed.begin, s * segmentBytes)};
+            const std::size_t last{std::min(changed.end, (s + 1) * segmentBytes)};
+            if (first < last) {
+                const std::size_t base{s * segmentBytes};
+                out.push_back(ByteRange{(first - base) * CHAR_BIT, (last - base) * CHAR_BIT});
+            }
+        }
+    }
+    static void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) {
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            std::uint8_t *dst{out[j]};
+            const std::size_t end{planeSize * j + first + count};
+            for (std::size_t b{planeSize * j + first}; b < end;) {
+                const std::size_t group{b / CHAR_BIT};
+                if (b % CHAR_BIT == 0 && end - b >= CHAR_BIT) {
+                    const std::size_t groups{(end - b) / CHAR_BIT};
+                    transposeBitPlanes(dst, idx + group, segmentBytes, groups);
+                    dst += groups * CHAR_BIT;
+                    b += groups * CHAR_BIT;
+                    continue;
+                }
+                // A group cut by either end of the run goes through scratch.
+                std::uint8_t scratch[CHAR_BIT];
+                transposeBitPlanes(scratch, idx + group, segmentBytes, 1);
+                const std::size_t n{std::min(end, (group + 1) * CHAR_BIT) - b};
+                std::memcpy(dst, scratch + b % CHAR_BIT, n);
+                dst += n;
+                b += n;
+            }
+        }
+    }
+};
+
+/*
+    The inverse of the bit planes: eighth s of the texture holds bit 7 - s of every index byte,
+    so each index byte is spread over eight bands of the image and even its lowest bits show.
+*/
+template <>
+struct SpatialPolicy<SpatialInterpretation::BIT_INTERLEAVED> {
+    static void ranges(ByteRange changed, std::vector<ByteRange> &out) {
+        const std::size_t firstGroup{changed.begin / CHAR_BIT};
+        const std::size_t lastGroup{(changed.end + CHAR_BIT - 1) / CHAR_BIT};
+        out.clear();
+        for (std::size_t s = 0; s < CHAR_BIT; ++s) {
+            out.push_back(ByteRange{s * segmentBytes + firstGroup, s * segmentBytes + lastGroup});
+        }
+    }
+    static void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) {
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            std::uint8_t *dst{out[j]};
+            const std::size_t end{planeSize * j + first + count};
+            for (std::size_t b{planeSize * j + first}; b < end;) {
+                const std::size_t s{b / segmentBytes};
+                const std::size_t n{std::min(end, (s + 1) * segmentBytes) - b};
+                extractBitRow(dst, idx + (b - s * segmentBytes) * CHAR_BIT, static_cast<unsigned>(s), n);
+                dst += n;
+                b += n;
+            }
+        }
+    }
+};
+
+/*
+    Layouts given by a pixel permutation share one policy. A contiguous change can land anywhere,
+    so it redraws the span between the first and last texture pixel it reaches, and gathering
+    copies whole pixels through the table, splitting off the channel bytes at either end.
+    Unlike the other policies it is an object, made once per render call: a custom layout can be
+    replaced at any time, and the snapshot it holds keeps one layout for the whole call.
+*/
+struct PermutedPolicy {
+    std::shared_ptr<const PixelPermutation> snapshot{};
+    const PixelPermutation &table;
+    explicit PermutedPolicy(const PixelPermutation &builtin) : table(builtin) {}
+    explicit PermutedPolicy(std::shared_ptr<const PixelPermutation> custom)
+        : snapshot(std::move(custom)), table(*snapshot) {}
+    void ranges(ByteRange changed, std::vector<ByteRange> &out) const {
+        out.clear();
+        const std::uint32_t *order{table.order()};
+        std::uint32_t low{UINT32_MAX}, high{0};
+        for (std::size_t n{changed.begin / imgCh}; n < (changed.end + imgCh - 1) / imgCh; ++n) {
+            low = std::min(low, order[n]);
+            high = std::max(high, order[n]);
+        }
+        if (low <= high) {
+            out.push_back(ByteRange{low * imgCh, (high + 1) * imgCh});
+        }
+    }
+    void gather(const std::uint8_t *idx, std::size_t first, std::size_t count, const Planes &out) const {
+        const std::uint32_t *source{table.source()};
+        for (std::size_t j = 0; j < imgCh; ++j) {
+            std::uint8_t *dst{out[j]};
+            std::size_t b{planeSize * j + first};
+            const std::size_t end{b + count};
+            for (; b < end && b % imgCh != 0; ++b) {
+                *dst++ = idx[source[b / imgCh] * imgCh + b % imgCh];
+            }
+            const std::size_t pixels{(end - b) / imgCh};
+            gatherPixels(dst, idx, textureBytes, source + b / imgCh, pixels);
+            dst += pixels * imgCh;
+            for (b += pixels * imgCh; b < end; ++b) {
+                *dst++ = idx[source[b / imgCh] * imgCh + b % imgCh];
+            }
+        }
+    }
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::HILBERT> : PermutedPolicy {
+    SpatialPolicy() : PermutedPolicy(hilbertPermutation()) {}
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::MORTON> : PermutedPolicy {
+    SpatialPolicy() : PermutedPolicy(mortonPermutation()) {}
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::TILED> : PermutedPolicy {
+    SpatialPolicy() : PermutedPolicy(tiledPermutation()) {}
+};
+
+template <>
+struct SpatialPolicy<SpatialInterpretation::CUSTOM> : PermutedPolicy {
+    SpatialPolicy() : PermutedPolicy(customPermutation()) {}
+};
+
+/*
+    One policy per color interpretation. convert() works in place on count pixels stored as three
+    consecutive channel rows of that length. Color conversions treat the texture as planar
+    channels, pixel N being (dst[N], dst[N + P], dst[N + 2P]), whatever spatial mode produced them;
+    identity modes are gathered straight into the texture instead.
+*/
+template <ColorSpaceInterpretation clr>
+struct ColorPolicy;
+
+template <>
+struct ColorPolicy<ColorSpaceInterpretation::RGB> {
+    static constexpr const bool identity{true};
+    static void convert(std::uint8_t *, std::size_t) {}
+};
+
+template <>
+struct ColorPolicy<ColorSpaceInterpretation::HSV> {
+    static constexpr const bool identity{false};
+    static void convert(std::uint8_t *block, std::size_t count) {
+        hsvToRgb(block, block + count, block + 2 * count, count);
+    }
+};
+
+template <>
+struct ColorPolicy<ColorSpaceInterpretation::YCBCR> {
+    static constexpr const bool identity{false};
+    static void convert(std::uint8_t *block, std::size_t count) {
+        ycbcrToRgb(block, block + count, block + 2 * count, count);
+    }
+};
+
+// Replaces pixels with the coalesced pixel runs of the planes that ranges of the texture touch.
+void pixelRuns(const std::vector<ByteRange> &ranges, std::vector<ByteRange> &pixels) {
+    pixels.clear();
+    for (const ByteRange &range : ranges) {
+        for (std::size_t plane{0}; plane < imgCh; ++plane) {
+            const std::size_t first{std::max(range.begin, plane * planeSize)};
+            const std::size_t last{std::min(range.end, (plane + 1) * planeSize)};
+            if (first < last) {
+                pixels.push_back(ByteRange{first - plane * planeSize, last - plane * planeSize});
+            }
+        }
+    }
+    coalesce(pixels);
+}
+
+template <SpatialInterpretation sp, ColorSpaceInterpretation clr>
+void render(const std::uint8_t *idx, ByteRange changed, std::uint8_t *dst, Renderer::Scratch &scratch) {
+    const SpatialPolicy<sp> spatialPolicy{};
+    using Color = ColorPolicy<clr>;
+    std::uint8_t *block{scratch.block.data()};
+    std::vector<ByteRange> &spatial{scratch.spatial};
+    std::vector<ByteRange> &runs{scratch.runs};
+    std::vector<ByteRange> &written{scratch.written};
+    spatialPolicy.ranges(changed, spatial);
+    pixelRuns(spatial, runs);
+    written.clear();
+    for (const ByteRange &run : runs) {
+        for (std::size_t first{run.begin}; first < run.end; first += blockPixels) {
+            const std::size_t count{std::min(blockPixels, run.end - first)};
+            const Planes planes{dst + first, dst + planeSize + first, dst + 2 * planeSize + first};
+            if constexpr (Color::identity) {
+                spatialPolicy.gather(idx, first, count, planes);
+            } else {
+                spatialPolicy.gather(idx, first, count, {block, block + count, block + 2 * count});
+                Color::convert(block, count);
+                for (std::size_t j = 0; j < imgCh; ++j) {
+                    std::memcpy(planes[j], block + j * count, count);
+                }
+            }
+        }
+        if constexpr (!Color::identity) {
+            for (std::size_t j = 0; j < imgCh; ++j) {
+                written.push_back(ByteRange{planeSize * j + run.begin, planeSize * j + run.end});
+            }
+        }
+    }
+    // Without a conversion, bytes rewritten around the spatial ranges come out unchanged.
+    if constexpr (Color::identity) {
+        written.assign(spatial.begin(), spatial.end());
+    }
+}
+
+constexpr const std::size_t spCount{static_cast<std::size_t>(SpatialInterpretation::COUNT)};
+constexpr const std::size_t clrCount{static_cast<std::size_t>(ColorSpaceInterpretation::COUNT)};
+
+using RenderFn = void (*)(const std::uint8_t *, ByteRange, std::uint8_t *, Renderer::Scratch &);
+
+// Entry sp * clrCount + clr is render<sp, clr>, every pair instantiated with its loops inlined.
+template <std::size_t... pair>
+constexpr std::array<RenderFn, sizeof...(pair)> makeRenderTable(std::index_sequence<pair...>) {
+    return {&render<static_cast<SpatialInterpretation>(pair / clrCount),
+                    static_cast<ColorSpaceInterpretation>(pair % clrCount)>...};
+}
+
+constexpr const std::array<RenderFn, spCount * clrCount> renderTable{
+    makeRenderTable(std::make_index_sequence<spCount * clrCount>{})
+};
+
+} // namespace
+
+void coalesce(std::vector<ByteRange> &ranges) {
+    std::sort(ranges.begin(), ranges.end(), [](const ByteRange &a, const ByteRange &b) { return a.begin < b.begin; });
+    // Merged ranges are written over the front of the vector, never past the range being read.
+    std::size_t merged{0};
+    for (const ByteRange &range : ranges) {
+        if (merged != 0 && range.begin <= ranges[merged - 1].end) {
+            ranges[merged - 1].end = std::max(ranges[merged - 1].end, range.end);
+        } else if (!range.empty()) {
+            ranges[merged++] = range;
+        }
+    }
+    ranges.resize(merged);
+}
+
+Renderer::Renderer() : scratch{std::vector<std::uint8_t>(blockPixels * imgCh)} {}
+
+const std::vector<ByteRange> &Renderer::render(
+    SpatialInterpretation sp, ColorSpaceInterpretation clr, const std::uint8_t *idx, ByteRange changed,
+    std::uint8_t *dst
+) {
+    const std::size_t spIdx{static_cast<std::size_t>(sp)};
+    const std::size_t clrIdx{static_cast<std::size_t>(clr)};
+    scratch.written.clear();
+    if (spIdx >= spCount || clrIdx >= clrCount) {
+        return scratch.written;
+    }
+    renderTable[spIdx * clrCount + clrIdx](idx, changed, dst, scratch);
+    return scratch.written;
+}
+
+const std::vector<ByteRange> &Renderer::renderAll(
+    SpatialInterpretation sp, ColorSpaceInterpretation clr, const std::uint8_t *idx, std::uint8_t *dst
+) {
+    return render(sp, clr, idx, ByteRange{0, textureBytes}, dst);
+}
+
+} // namespace glb
@@ -0,0 +1,177 @@
+#include "glb_upload.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace glb {
+
+namespace {
+
+constexpr const std::size_t rowBytes{imgWidth * imgCh};
+constexpr const std::size_t slotBytes{rowBytes * imgHeight};
+// A slot is only reused three frames later, by then its fence has all but certainly passed.
+constexpr const GLuint64 fenceTimeoutNs{1'000'000'000};
+
+std::string pathOverride() {
+#ifdef _MSC_VER
+    char *value{};
+    std::size_t size{};
+    if (_dupenv_s(&value, &size, "GLB_UPLOAD_PATH") != 0 || !value) {
+        return {};
+    }
+    std::string result{value};
+    std::free(value);
+    return result;
+#else
+    const char *value{std::getenv("GLB_UPLOAD_PATH")};
+    return value ? std::string{value} : std::string{};
+#endif
+}
+
+// Paths are ordered best first, so capping means taking the later of the two.
+UploadPath capPath(UploadPath best) {
+    const std::string requested{pathOverride()};
+    constexpr const char *names[]{"persistent", "mapped", "direct"};
+    for (int path{0}; path < static_cast<int>(std::size(names)); ++path) {
+        if (requested == names[path]) {
+            return std::max(best, static_cast<UploadPath>(path));
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+void TextureUploader::init(GLuint textureId, UploadPath best) {
+    texture = textureId;
+    best = capPath(best);
+    // Rows are 3840 bytes, which keeps the default unpack alignment of 4 valid.
+    if (best == UploadPath::PERSISTENT && (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) && createPersistent()) {
+        path = UploadPath::PERSISTENT;
+    } else if (best != UploadPath::DIRECT && GLAD_GL_VERSION_3_0 && createMapped()) {
+        path = UploadPath::MAPPED;
+    } else {
+        path = UploadPath::DIRECT;
+    }
+}
+
+bool TextureUploader::createPersistent() {
+    constexpr const GLbitfield flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT};
+    for (Slot &slot : slots) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slotBytes, nullptr, flags);
+        slot.mapped = static_cast<std::uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slotBytes, flags));
+        if (!slot.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            destroy();
+            return false;
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+bool TextureUploader::createMapped() {
+    for (Slot &slot : slots) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, slotBytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+
+/*
+    Binds the slot and returns where to write, waiting for the GPU only if it still reads from it.
+    Returns null if it cannot be written now: a fence still pending after the timeout means the
+    GPU has not copied the slot out yet, and a failed wait says nothing about it. Either way the
+    fence stays, to be waited on again the next time this slot comes round.
+*/
+std::uint8_t *TextureUploader::acquire(Slot &slot) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    if (path == UploadPath::PERSISTENT) {
+        if (slot.fence) {
+            const GLenum status{glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeoutNs)};
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                return nullptr;
+            }
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        return slot.mapped;
+    }
+    // Invalidating lets the driver hand out fresh storage instead of waiting on the old one.
+    return static_cast<std::uint8_t *>(
+        glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slotBytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)
+    );
+}
+
+// base is a client address, or an offset into the bound unpack buffer.
+void TextureUploader::upload(std::uintptr_t base, const std::vector<ByteRange> &rows) {
+    for (const ByteRange &range : rows) {
+        glTexSubImage2D(
+            GL_TEXTURE_2D, 0, 0, static_cast<GLint>(range.begin), imgWidth,
+            static_cast<GLsizei>(range.end - range.begin), GL_RGB, GL_UNSIGNED_BYTE,
+            reinterpret_cast<const void *>(base + range.begin * rowBytes)
+        );
+    }
+}
+
+void TextureUploader::submit(const std::uint8_t *src, const std::vector<ByteRange> &rows) {
+    if (rows.empty()) {
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (path == UploadPath::DIRECT) {
+        upload(reinterpret_cast<std::uintptr_t>(src), rows);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return;
+    }
+    Slot &slot{slots[next]};
+    next = (next + 1) % slotCount;
+    std::uint8_t *dst{acquire(slot)};
+    if (!dst) {
+        // The slot is busy, or mapping failed on a lost or starved context; the frame still has to arrive.
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload(reinterpret_cast<std::uintptr_t>(src), rows);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return;
+    }
+    // Rows outside the dirty ranges may be stale in this slot, but are never read from it.
+    for (const ByteRange &range : rows) {
+        const std::size_t offset{range.begin * rowBytes};
+        std::memcpy(dst + offset, src + offset, (range.end - range.begin) * rowBytes);
+    }
+    if (path == UploadPath::MAPPED) {
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    upload(0, rows);
+    if (path == UploadPath::PERSISTENT) {
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TextureUploader::destroy() {
+    for (Slot &slot : slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        if (slot.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        if (slot.buffer) {
+            glDeleteBuffers(1, &slot.buffer);
+        }
+        slot = Slot{};
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    path = UploadPath::DIRECT;
+}
+
+} // namespace glb
@@ -0,0 +1,120 @@
+#include "glb_common.hpp"
+#include "glb_cpu.hpp"
+#include "glb_index.hpp"
+#include "glb_kernels.hpp"
+#include <algorithm>
+#include <boost/multiprecision/cpp_int/import_export.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <vector>
+
+/*
+    grayEncode, grayDecode and philoxFill at whichever tier GLB_CPU_TIER selects; CTest runs it
+    once per tier. Gray codes are checked against x ^ x >> 1 on cpp_int and by the round trip,
+    Philox against the published known-answer vector and a plain implementation of the cipher.
+*/
+
+namespace {
+
+namespace mp = glb::mp;
+
+// Odd sizes on both sides of every vector width, and a whole image.
+constexpr const std::size_t grayLengths[]{1, 7, 31, 33, glb::ImageIndex::byteCount};
+constexpr const std::size_t philoxLength{(std::size_t{1} << 20) + 5};
+constexpr const std::uint64_t philoxKey{0x0123456789ABCDEF};
+
+std::size_t failures{0};
+std::size_t checks{0};
+
+void expect(bool ok, const char *name, std::size_t n, const char *what) {
+    ++checks;
+    if (!ok && failures++ < 20) {
+        std::printf("%s, %zu bytes: %s\n", name, n, what);
+    }
+}
+
+// value as exactly n big-endian bytes, export_bits leaves out the leading zeros.
+std::vector<std::uint8_t> toBytes(const mp::cpp_int &value, std::size_t n) {
+    std::vector<std::uint8_t> bytes{};
+    if (value != 0) {
+        mp::export_bits(value, std::back_inserter(bytes), CHAR_BIT);
+    }
+    bytes.insert(bytes.begin(), n - bytes.size(), 0);
+    return bytes;
+}
+
+void checkGray(std::mt19937_64 &rng) {
+    for (const std::size_t n : grayLengths) {
+        std::vector<std::uint8_t> plain(n);
+        for (std::uint8_t &byte : plain) {
+            byte = static_cast<std::uint8_t>(rng());
+        }
+        mp::cpp_int x{};
+        mp::import_bits(x, plain.begin(), plain.end(), CHAR_BIT);
+        const std::vector<std::uint8_t> expected{toBytes(x ^ (x >> 1), n)};
+
+        std::vector<std::uint8_t> encoded(n), decoded(n);
+        glb::grayEncode(encoded.data(), plain.data(), n, 0);
+        expect(encoded == expected, "grayEncode", n, "differs from x ^ x >> 1");
+        glb::grayDecode(decoded.data(), encoded.data(), n);
+        expect(decoded == plain, "grayDecode", n, "does not invert grayEncode");
+
+        // Both may run in place.
+        std::vector<std::uint8_t> inPlace{plain};
+        glb::grayEncode(inPlace.data(), inPlace.data(), n, 0);
+        expect(inPlace == expected, "grayEncode in place", n, "differs from x ^ x >> 1");
+        glb::grayDecode(inPlace.data(), inPlace.data(), n);
+        expect(inPlace == plain, "grayDecode in place", n, "does not invert grayEncode");
+    }
+}
+
+// Philox4x32-10 as written in the paper, one block at a time.
+void referencePhilox(std::uint8_t *dst, std::uint64_t block, std::uint64_t key) {
+    std::uint32_t c[4]{static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32), 0, 0};
+    std::uint32_t k[2]{static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32)};
+    for (int round{0}; round < 10; ++round) {
+        const std::uint64_t p0{std::uint64_t{0xD2511F53} * c[0]};
+        const std::uint64_t p1{std::uint64_t{0xCD9E8D57} * c[2]};
+        const std::uint32_t next[4]{
+            static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k[0], static_cast<std::uint32_t>(p1),
+            static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k[1], static_cast<std::uint32_t>(p0)
+        };
+        std::memcpy(c, next, sizeof(c));
+        k[0] += 0x9E3779B9;
+        k[1] += 0xBB67AE85;
+    }
+    std::memcpy(dst, c, sizeof(c));
+}
+
+void checkPhilox() {
+    // Random123's kat_vectors: counter 0 and key 0 give 6627e8d5 e169c58d bc57ac4c 9b00dbd8.
+    const std::uint32_t known[4]{0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8};
+    std::uint8_t block[16]{};
+    glb::philoxFill(block, sizeof(block), 0);
+    expect(std::memcmp(block, known, sizeof(block)) == 0, "philoxFill", sizeof(block), "misses the known answer");
+    referencePhilox(block, 0, 0);
+    expect(std::memcmp(block, known, sizeof(block)) == 0, "referencePhilox", sizeof(block), "misses the known answer");
+
+    // The ragged end goes through the single-block path.
+    std::vector<std::uint8_t> actual(philoxLength), expected(philoxLength + sizeof(block));
+    glb::philoxFill(actual.data(), philoxLength, philoxKey);
+    for (std::size_t b{0}; b * sizeof(block) < philoxLength; ++b) {
+        referencePhilox(expected.data() + b * sizeof(block), b, philoxKey);
+    }
+    expect(std::equal(actual.begin(), actual.end(), expected.begin()), "philoxFill", philoxLength,
+           "differs from the reference stream");
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng{0x9E3779B97F4A7C15};
+    checkGray(rng);
+    checkPhilox();
+    std::printf("bit kernels at %s: %zu of %zu checks failed\n", glb::tierGetStr(glb::cpuTier()), failures, checks);
+    return failures == 0 ? 0 : 1;
+}
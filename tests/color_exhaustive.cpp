@@ -0,0 +1,76 @@
+#define cimg_display 0
+#include "CImg.h"
+#include "glb_cpu.hpp"
+#include "glb_kernels.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/*
+    hsvToRgb and ycbcrToRgb against CImg's HSVtoRGBModified and YCbCrtoRGB over every one of the
+    2^24 input triples, at whichever tier GLB_CPU_TIER selects; CTest runs it once per tier. A
+    second run over an odd-sized, odd-offset slice covers the scalar tails of the SIMD loops.
+*/
+
+namespace {
+
+constexpr const std::size_t side{4096};
+constexpr const std::size_t count{side * side}; // Every 24-bit triple exactly once.
+constexpr const std::size_t sliceOffset{3};
+constexpr const std::size_t sliceCount{1'000'003};
+
+using Kernel = void (*)(std::uint8_t *, std::uint8_t *, std::uint8_t *, std::size_t);
+
+std::size_t check(const char *name, Kernel kernel, const cimg_library::CImg<std::uint8_t> &input,
+                  const cimg_library::CImg<std::uint8_t> &expected) {
+    cimg_library::CImg<std::uint8_t> actual(input);
+    kernel(actual.data(0, 0, 0, 0), actual.data(0, 0, 0, 1), actual.data(0, 0, 0, 2), count);
+    std::size_t mismatches{0};
+    for (std::size_t k = 0; k < count; ++k) {
+        for (unsigned c = 0; c < 3; ++c) {
+            if (actual.data()[c * count + k] != expected.data()[c * count + k]) {
+                if (mismatches++ < 5) {
+                    std::printf("%s: input %06zx channel %u gives %u, CImg %u\n", name, k, c,
+                                actual.data()[c * count + k], expected.data()[c * count + k]);
+                }
+            }
+        }
+    }
+    // Same conversion on a slice whose start and length line up with no vector width.
+    cimg_library::CImg<std::uint8_t> slice(input);
+    kernel(slice.data(0, 0, 0, 0) + sliceOffset, slice.data(0, 0, 0, 1) + sliceOffset,
+           slice.data(0, 0, 0, 2) + sliceOffset, sliceCount);
+    for (unsigned c = 0; c < 3; ++c) {
+        const std::size_t plane{c * count};
+        for (std::size_t k = 0; k < count; ++k) {
+            const bool inside{k >= sliceOffset && k < sliceOffset + sliceCount};
+            const std::uint8_t want{inside ? expected.data()[plane + k] : input.data()[plane + k]};
+            if (slice.data()[plane + k] != want && mismatches++ < 5) {
+                std::printf("%s: slice input %06zx channel %u gives %u, expected %u\n", name, k, c,
+                            slice.data()[plane + k], want);
+            }
+        }
+    }
+    std::printf("%s at %s: %zu mismatches\n", name, glb::tierGetStr(glb::cpuTier()), mismatches);
+    return mismatches;
+}
+
+} // namespace
+
+int main() {
+    cimg_library::CImg<std::uint8_t> input(side, side, 1, 3);
+    for (std::size_t k = 0; k < count; ++k) {
+        input.data()[k] = static_cast<std::uint8_t>(k >> 16);
+        input.data()[count + k] = static_cast<std::uint8_t>(k >> 8);
+        input.data()[2 * count + k] = static_cast<std::uint8_t>(k);
+    }
+    cimg_library::CImg<std::uint8_t> hsv(input);
+    hsv.HSVtoRGBModified();
+    cimg_library::CImg<std::uint8_t> ycbcr(input);
+    ycbcr.YCbCrtoRGB();
+    const std::size_t mismatches{check("hsvToRgb", glb::hsvToRgb, input, hsv) +
+                                 check("ycbcrToRgb", glb::ycbcrToRgb, input, ycbcr)};
+    return mismatches == 0 ? 0 : 1;
+}
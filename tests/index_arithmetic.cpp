@@ -0,0 +1,359 @@
+#include "glb_common.hpp"
+#include "glb_cpu.hpp"
+#include "glb_index.hpp"
+#include "glb_kernels.hpp"
+#include <algorithm>
+#include <boost/multiprecision/cpp_int/import_export.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+    ImageIndex against cpp_int doing the same arithmetic, at whichever tier GLB_CPU_TIER selects;
+    CTest runs it once per tier. Every step also checks that the dirty range the index reports
+    covers every byte that actually changed. The addLimbs and subLimbs kernels underneath are
+    checked on their own against the scalar carry chain, changed range included.
+*/
+
+namespace {
+
+namespace mp = glb::mp;
+using glb::ImageIndex;
+using Limb = ImageIndex::Limb;
+
+constexpr const std::size_t limbBits{ImageIndex::limbBits};
+// Around every vector width the carry kernels use, and a few long runs.
+constexpr const std::size_t lengths[]{1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 1000, ImageIndex::limbCount - 1};
+constexpr const std::size_t walkSteps{300};
+// Past the longest run any tier handles at once, and tails of every size after whole vectors.
+constexpr const std::size_t kernelLengths[]{31, 32, 33, 63, 64, 65, 100, 1027};
+constexpr const std::size_t kernelTrials{20};
+
+const mp::cpp_int &maxValue() {
+    static const mp::cpp_int value{(mp::cpp_int{1} << glb::maxB2) - 1};
+    return value;
+}
+
+mp::cpp_int saturate(const mp::cpp_int &value) {
+    if (value < 0) {
+        return 0;
+    }
+    return value > maxValue() ? maxValue() : value;
+}
+
+mp::cpp_int ones(std::size_t bits) { return (mp::cpp_int{1} << bits) - 1; }
+
+// limbs random limbs, the top one nonzero so the value really is that long.
+mp::cpp_int randomValue(std::mt19937_64 &rng, std::size_t limbs) {
+    std::vector<Limb> words(limbs);
+    for (Limb &word : words) {
+        word = rng();
+    }
+    words.front() |= Limb{1} << (limbBits - 1 - rng() % limbBits);
+    mp::cpp_int value{};
+    mp::import_bits(value, words.begin(), words.end(), limbBits);
+    return value;
+}
+
+ImageIndex makeIndex(const mp::cpp_int &value) {
+    ImageIndex index{};
+    index.assign(value);
+    return index;
+}
+
+class Checker {
+  private:
+    std::vector<std::uint8_t> before = std::vector<std::uint8_t>(ImageIndex::byteCount);
+    std::size_t checks{0};
+    std::size_t failures{0};
+
+    void fail(const char *name, const char *what) {
+        if (failures++ < 20) {
+            std::printf("%s: %s\n", name, what);
+        }
+    }
+
+  public:
+    void expect(bool ok, const char *name, const char *what) {
+        ++checks;
+        if (!ok) {
+            fail(name, what);
+        }
+    }
+
+    // Runs op on index, which should then hold expected, and checks the bytes op changed were all marked dirty.
+    template <typename Op>
+    void step(const char *name, ImageIndex &index, const mp::cpp_int &expected, const Op &op) {
+        ++checks;
+        std::copy_n(index.bytes(), ImageIndex::byteCount, before.begin());
+        index.takeDirty();
+        op();
+        const glb::ByteRange dirty{index.takeDirty()};
+        if (index.toCppInt() != expected) {
+            fail(name, "value differs from cpp_int");
+        }
+        const std::uint8_t *after{index.bytes()};
+        std::size_t first{0}, last{ImageIndex::byteCount};
+        while (first < last && before[first] == after[first]) {
+            ++first;
+        }
+        while (last > first && before[last - 1] == after[last - 1]) {
+            --last;
+        }
+        if (first < last && (first < dirty.begin || last > dirty.end)) {
+            std::printf(
+                "%s: bytes %zu to %zu changed, dirty range is %zu to %zu\n", name, first, last, dirty.begin, dirty.end
+            );
+            fail(name, "dirty range misses changed bytes");
+        }
+    }
+
+    int finish() const {
+        std::printf("index arithmetic at %s: %zu of %zu checks failed\n", glb::tierGetStr(glb::cpuTier()), failures,
+                    checks);
+        return failures == 0 ? 0 : 1;
+    }
+};
+
+void checkCarries(Checker &checker) {
+    // A carry in at the bottom that runs through every limb boundary, and the borrow undoing it.
+    ImageIndex index{makeIndex(ones(glb::maxB2 - 1))};
+    const ImageIndex one{makeIndex(1)};
+    checker.step("carry through every limb", index, mp::cpp_int{1} << (glb::maxB2 - 1),
+                 [&] { index.addSaturate(one); });
+    checker.step("borrow through every limb", index, ones(glb::maxB2 - 1), [&] { index.subSaturate(one); });
+    for (const std::size_t n : lengths) {
+        // Inside the carry kernel: rhs spans all n limbs and the carry starts in the lowest one.
+        const mp::cpp_int run{ones(n * limbBits)};
+        const mp::cpp_int wide{(mp::cpp_int{1} << ((n - 1) * limbBits)) + 1};
+        ImageIndex sum{makeIndex(run)};
+        checker.step("carry across a run", sum, run + wide, [&] { sum.addSaturate(makeIndex(wide)); });
+        checker.step("borrow across a run", sum, run, [&] { sum.subSaturate(makeIndex(wide)); });
+        // Past rhs, in the loop that finishes a carry or borrow one limb at a time.
+        ImageIndex past{makeIndex(run)};
+        checker.step("carry past rhs", past, run + 1, [&] { past.addSaturate(one); });
+        checker.step("borrow past rhs", past, run, [&] { past.subSaturate(one); });
+        checker.step("scaled carry past rhs", past, run + 3, [&] { past.addScaled(one, 3); });
+        checker.step("scaled borrow past rhs", past, run, [&] { past.subScaled(one, 3); });
+    }
+}
+
+void checkSaturation(Checker &checker, std::mt19937_64 &rng) {
+    const ImageIndex one{makeIndex(1)};
+    const ImageIndex top{makeIndex(maxValue())};
+    ImageIndex index{makeIndex(maxValue())};
+    checker.step("max + 1", index, maxValue(), [&] { index.addSaturate(one); });
+    checker.step("max + max", index, maxValue(), [&] { index.addSaturate(top); });
+    checker.step("max - 1", index, maxValue() - 1, [&] { index.subSaturate(one); });
+    checker.step("max - 1 + 2", index, maxValue(), [&] { index.addSaturate(makeIndex(2)); });
+    checker.step("max - max", index, 0, [&] { index.subSaturate(top); });
+    checker.step("0 - 1", index, 0, [&] { index.subSaturate(one); });
+    checker.step("0 - max", index, 0, [&] { index.subSaturate(top); });
+
+    const mp::cpp_int third{maxValue() / 3};
+    const ImageIndex thirdIndex{makeIndex(third)};
+    checker.step("third * 3", index, third * 3, [&] { index.addScaled(thirdIndex, 3); });
+    checker.step("+ third * 3 saturates", index, maxValue(), [&] { index.addScaled(thirdIndex, 3); });
+    checker.step("- third * 4 saturates", index, 0, [&] { index.subScaled(thirdIndex, 4); });
+    checker.step("+ 1 * ~0", index, ~Limb{0}, [&] { index.addScaled(one, ~Limb{0}); });
+    checker.step("- 1 * ~0", index, 0, [&] { index.subScaled(one, ~Limb{0}); });
+
+    for (const std::size_t n : lengths) {
+        const mp::cpp_int a{randomValue(rng, n)}, b{randomValue(rng, n)};
+        const Limb k{rng()};
+        index.assign(a);
+        const ImageIndex rhs{makeIndex(b)};
+        checker.step("a - b", index, saturate(a - b), [&] { index.subSaturate(rhs); });
+        index.assign(maxValue() - a);
+        checker.step("max - a + b", index, saturate(maxValue() - a + b), [&] { index.addSaturate(rhs); });
+        index.assign(maxValue() - a);
+        checker.step("max - a + b * k", index, saturate(maxValue() - a + b * k), [&] { index.addScaled(rhs, k); });
+        index.assign(a);
+        checker.step("a - b * k", index, saturate(a - b * k), [&] { index.subScaled(rhs, k); });
+        index.assign(b * k);
+        checker.step("b * k - b * k", index, 0, [&] { index.subScaled(rhs, k); });
+    }
+}
+
+/*
+    A random sequence of every mutation on one index, operands from one limb up to the full width,
+    so that the used bound is grown and shrunk by each of them in turn.
+*/
+void checkWalk(Checker &checker, std::mt19937_64 &rng) {
+    ImageIndex index{};
+    mp::cpp_int expected{};
+    std::vector<std::uint8_t> source(ImageIndex::byteCount);
+    const auto operandLimbs{[&] {
+        const std::size_t n{lengths[rng() % std::size(lengths)]};
+        return 1 + rng() % n;
+    }};
+    for (std::size_t s{0}; s < walkSteps; ++s) {
+        switch (rng() % 6) {
+        case 0: {
+            const mp::cpp_int b{randomValue(rng, operandLimbs())};
+            const ImageIndex rhs{makeIndex(b)};
+            expected = saturate(expected + b);
+            checker.step("addSaturate", index, expected, [&] { index.addSaturate(rhs); });
+            break;
+        }
+        case 1: {
+            const mp::cpp_int b{randomValue(rng, operandLimbs())};
+            const ImageIndex rhs{makeIndex(b)};
+            expected = saturate(expected - b);
+            checker.step("subSaturate", index, expected, [&] { index.subSaturate(rhs); });
+            break;
+        }
+        case 2: {
+            const mp::cpp_int b{randomValue(rng, operandLimbs())};
+            const ImageIndex rhs{makeIndex(b)};
+            const Limb k{rng() >> (rng() % limbBits)};
+            expected = saturate(expected + b * k);
+            checker.step("addScaled", index, expected, [&] { index.addScaled(rhs, k); });
+            break;
+        }
+        case 3: {
+            const mp::cpp_int b{randomValue(rng, operandLimbs())};
+            const ImageIndex rhs{makeIndex(b)};
+            const Limb k{rng() >> (rng() % limbBits)};
+            expected = saturate(expected - b * k);
+            checker.step("subScaled", index, expected, [&] { index.subScaled(rhs, k); });
+            break;
+        }
+        case 4: {
+            // Zero often enough to clear the top limb and shrink the used bound.
+            const std::size_t i{rng() % operandLimbs()};
+            const Limb value{rng() % 3 == 0 ? 0 : rng()};
+            const mp::cpp_int old{(expected >> (i * limbBits)) & ones(limbBits)};
+            expected += (mp::cpp_int{value} - old) << (i * limbBits);
+            checker.step("setLimb", index, expected, [&] { index.setLimb(i, value); });
+            break;
+        }
+        default: {
+            // Big-endian from the top, so a short source leaves the low bytes zero.
+            const std::size_t size{rng() % 2 == 0 ? ImageIndex::byteCount : operandLimbs() * sizeof(Limb) - 3};
+            for (std::size_t k{0}; k < size; ++k) {
+                source[k] = static_cast<std::uint8_t>(rng());
+            }
+            expected = 0;
+            mp::import_bits(expected, source.begin(), source.begin() + size, CHAR_BIT);
+            expected <<= (ImageIndex::byteCount - size) * CHAR_BIT;
+            checker.step("assignBytes", index, expected, [&] { index.assignBytes(source.data(), size); });
+            break;
+        }
+        }
+    }
+}
+
+// carryScalar from glb_kernels.cpp, the chain the vector tiers have to agree with.
+template <bool subtract>
+Limb referenceCarry(Limb *dst, const Limb *src, std::size_t n, Limb carry) {
+    for (std::size_t i{n}; i-- > 0;) {
+        const Limb a{glb::bswap64(dst[i])}, b{glb::bswap64(src[i])};
+        Limb out{};
+        if constexpr (subtract) {
+            const Limb diff{a - b};
+            out = diff - carry;
+            carry = (a < b) | (diff < carry);
+        } else {
+            const Limb sum{a + b};
+            out = sum + carry;
+            carry = (sum < a) | (out < sum);
+        }
+        dst[i] = glb::bswap64(out);
+    }
+    return carry;
+}
+
+// The first and one past the last byte that differ, empty if none does.
+glb::ByteRange changedBytes(const Limb *before, const Limb *after, std::size_t n) {
+    const auto *a{reinterpret_cast<const std::uint8_t *>(before)};
+    const auto *b{reinterpret_cast<const std::uint8_t *>(after)};
+    std::size_t first{0}, last{n * sizeof(Limb)};
+    while (first < last && a[first] == b[first]) {
+        ++first;
+    }
+    while (last > first && a[last - 1] == b[last - 1]) {
+        --last;
+    }
+    return first < last ? glb::ByteRange{first, last} : glb::ByteRange{};
+}
+
+enum class Pattern { Random, Ones, Zeros, Mixed };
+
+// Runs of all ones and all zeros are what make a carry or borrow ripple through whole vectors.
+void fill(Limb *limbs, std::size_t n, Pattern pattern, std::mt19937_64 &rng) {
+    for (std::size_t i{0}; i < n; ++i) {
+        Limb value{};
+        switch (pattern) {
+        case Pattern::Random: value = rng(); break;
+        case Pattern::Ones: value = ~Limb{0}; break;
+        case Pattern::Zeros: value = 0; break;
+        case Pattern::Mixed: {
+            const Limb choices[]{0, ~Limb{0}, 1, ~Limb{0} - 1, rng()};
+            value = choices[rng() % std::size(choices)];
+            break;
+        }
+        }
+        limbs[i] = glb::bswap64(value);
+    }
+}
+
+template <bool subtract>
+void checkKernel(Checker &checker, std::size_t n, Pattern dstPattern, Pattern srcPattern, std::mt19937_64 &rng) {
+    const char *name{subtract ? "subLimbs" : "addLimbs"};
+    // One spare limb in front, so that half the runs start off the allocation's alignment.
+    std::vector<Limb> original(n + 1), src(n + 1), expected(n + 1), actual(n + 1);
+    const std::size_t offset{rng() % 2};
+    fill(original.data() + offset, n, dstPattern, rng);
+    fill(src.data() + offset, n, srcPattern, rng);
+    for (const Limb carry : {Limb{0}, Limb{1}}) {
+        expected = original;
+        actual = original;
+        const Limb expectedCarry{referenceCarry<subtract>(expected.data() + offset, src.data() + offset, n, carry)};
+        glb::ByteRange changed{};
+        const Limb actualCarry{
+            subtract ? glb::subLimbs(actual.data() + offset, src.data() + offset, n, carry, changed)
+                     : glb::addLimbs(actual.data() + offset, src.data() + offset, n, carry, changed)
+        };
+        const glb::ByteRange want{changedBytes(original.data() + offset, expected.data() + offset, n)};
+        checker.expect(actual == expected, name, "limbs differ from the scalar chain");
+        checker.expect(actualCarry == expectedCarry, name, "carry out differs from the scalar chain");
+        checker.expect(
+            changed.empty() ? want.empty() : changed.begin == want.begin && changed.end == want.end, name,
+            "changed range is not exactly the bytes that changed"
+        );
+    }
+}
+
+void checkKernels(Checker &checker, std::mt19937_64 &rng) {
+    const Pattern patterns[]{Pattern::Random, Pattern::Ones, Pattern::Zeros, Pattern::Mixed};
+    std::vector<std::size_t> sizes(kernelLengths, kernelLengths + std::size(kernelLengths));
+    for (std::size_t n{0}; n <= 17; ++n) {
+        sizes.push_back(n);
+    }
+    for (const std::size_t n : sizes) {
+        for (const Pattern dst : patterns) {
+            for (const Pattern src : patterns) {
+                const std::size_t trials{dst == Pattern::Mixed || src == Pattern::Mixed ? kernelTrials : 1};
+                for (std::size_t t{0}; t < trials; ++t) {
+                    checkKernel<false>(checker, n, dst, src, rng);
+                    checkKernel<true>(checker, n, dst, src, rng);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng{0x9E3779B97F4A7C15};
+    Checker checker{};
+    checkKernels(checker, rng);
+    checkCarries(checker);
+    checkSaturation(checker, rng);
+    checkWalk(checker, rng);
+    return checker.finish();
+}